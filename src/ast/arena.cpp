@@ -0,0 +1,42 @@
+#include "ast/arena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+using namespace bloop::ast;
+
+constexpr std::size_t BLOCK_SIZE = 0x10000u;
+
+static thread_local Arena* currentArena{};
+
+Arena::~Arena() = default;
+
+void* Arena::Allocate(std::size_t size, std::size_t alignment) {
+
+	const auto Padding = [alignment](const std::byte* p) {
+		return (alignment - reinterpret_cast<std::uintptr_t>(p) % alignment) % alignment;
+	};
+
+	if (!m_pPos || Padding(m_pPos) + size > static_cast<std::size_t>(m_pEnd - m_pPos)) {
+		// not zeroed, every node initializes itself
+		const auto blockSize = std::max(BLOCK_SIZE, size + alignment);
+		m_pPos = m_oBlocks.emplace_back(new std::byte[blockSize]).get();
+		m_pEnd = m_pPos + blockSize;
+	}
+
+	const auto pos = m_pPos + Padding(m_pPos);
+	m_pPos = pos + size;
+	m_uNumBytes += size;
+	return pos;
+}
+
+Arena::Scope::Scope(Arena& arena) noexcept : m_pPrevious(std::exchange(currentArena, &arena)) {}
+Arena::Scope::~Scope() {
+	currentArena = m_pPrevious;
+}
+
+Arena& Arena::Current() noexcept {
+	assert(currentArena);
+	return *currentArena;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "utils/defs.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bloop::ast {
+
+	// a bump allocator for the nodes of one program
+	// nothing is freed on its own, every block goes at once when the arena is destroyed
+	class Arena final {
+	public:
+		Arena() = default;
+		~Arena();
+		BLOOP_NONCOPYABLE(Arena);
+
+		[[nodiscard]] void* Allocate(std::size_t size, std::size_t alignment);
+		[[nodiscard]] std::size_t GetNumBytes() const noexcept { return m_uNumBytes; }
+
+		// new nodes go to this arena while the scope is alive
+		class Scope final {
+		public:
+			Scope(Arena& arena) noexcept;
+			~Scope();
+			BLOOP_NONCOPYABLE(Scope);
+		private:
+			Arena* m_pPrevious{};
+		};
+
+		[[nodiscard]] static Arena& Current() noexcept;
+
+	private:
+		std::vector<std::unique_ptr<std::byte[]>> m_oBlocks;
+		std::byte* m_pPos{};
+		std::byte* m_pEnd{};
+		std::size_t m_uNumBytes{};
+	};
+
+	// the memory belongs to the arena, so deleting a node only destroys it
+	struct NodeDeleter {
+		template<typename T>
+		void operator()(T* node) const noexcept { node->~T(); }
+	};
+
+	template<typename T>
+	using NodePtr = std::unique_ptr<T, NodeDeleter>;
+
+	template<typename T, typename... Args>
+	[[nodiscard]] NodePtr<T> Make(Args&&... args) {
+		auto memory = Arena::Current().Allocate(sizeof(T), alignof(T));
+		return NodePtr<T>(new (memory) T(std::forward<Args>(args)...));
+	}
+}
@@ -9,10 +9,10 @@ void AssignExpression::EmitByteCode(TBCBuilder& builder) {
 	//look for the identifier from the unary/postfix chain
 	if (const auto ptr = left->GetIdentifier()) {
 
-		if (auto pf = dynamic_cast<FunctionCall*>(left.get()))
+		if (auto pf = As<FunctionCall>(left.get()))
 			throw exception::ResolverError(BLOOPTEXT("invalid lhs operand"), m_oApproximatePosition);
 
-		if (auto pf = dynamic_cast<Subscript*>(left.get())) {
+		if (auto pf = As<Subscript>(left.get())) {
 			pf->EmitSet(builder);
 			if (!IsStatement())
 				pf->EmitGet(builder); // (arr[0] = 2) < 10
@@ -26,6 +26,13 @@ void AssignExpression::EmitByteCode(TBCBuilder& builder) {
 				Emit(builder, TOpCode::LOAD_LOCAL, ptr->m_oResolver.m_uSlot);
 			break;
 		case IdentifierExpression::ResolvedIdentifier::Kind::Upvalue:
+			if (builder.m_oEnclosingSlots) {
+				const auto slot = builder.m_oEnclosingSlots->m_oUpValues.at(ptr->m_oResolver.m_uSlot);
+				Emit(builder, TOpCode::STORE_ENCLOSING, slot);
+				if (!IsStatement())
+					Emit(builder, TOpCode::LOAD_ENCLOSING, slot);
+				break;
+			}
 			Emit(builder, TOpCode::STORE_UPVALUE, ptr->m_oResolver.m_uSlot);
 			if (!IsStatement())
 				Emit(builder, TOpCode::LOAD_UPVALUE, ptr->m_oResolver.m_uSlot);
@@ -35,6 +42,8 @@ void AssignExpression::EmitByteCode(TBCBuilder& builder) {
 			if (!IsStatement())
 				Emit(builder, TOpCode::LOAD_GLOBAL, ptr->m_oResolver.m_uSlot);
 			break;
+		case IdentifierExpression::ResolvedIdentifier::Kind::CapturedConst:
+			throw bloop::exception::ResolverError(BLOOPTEXT("lhs is declared as const"), left->m_oApproximatePosition);
 		}
 
 		return;
@@ -46,10 +55,13 @@ void AssignExpression::EmitByteCode(TBCBuilder& builder) {
 void AssignExpression::Resolve(TResolver& resolver) {
 	BinaryExpression::Resolve(resolver);
 
-	if (auto pf = dynamic_cast<FunctionCall*>(left.get()))
+	if (auto pf = As<FunctionCall>(left.get()))
 		throw exception::ResolverError(BLOOPTEXT("can't assign function calls"), m_oApproximatePosition);
 
 	if (left->IsConst())
 		throw bloop::exception::ResolverError(BLOOPTEXT("lhs is declared as const"), left->m_oApproximatePosition);
 
+	// the array may belong to the caller, so the call changes more than its result
+	if (As<Subscript>(left.get()))
+		resolver.MarkImpure();
 }
\ No newline at end of file
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "utils/defs.hpp"
+#include "ast/arena.hpp"
 #include "lexer/token.hpp"
 #include "resolver/resolver.hpp"
 #include "resolver/exception.hpp"
+#include "optimizer/optimizer.hpp"
 #include "bytecode/compile/emit.hpp"
 #include "bytecode/exception.hpp"
 
@@ -12,15 +14,56 @@
 #include <utility>
 #include <optional>
 
+namespace bloop::ir {
+	struct Builder;
+	struct Instruction;
+}
+
 namespace bloop::ast {
 	using TResolver = bloop::resolver::internal::Resolver;
+	using TOptimizer = bloop::optimizer::internal::Optimizer;
 	using TBCBuilder = bloop::bytecode::CByteCodeBuilder;
+	using TIRBuilder = bloop::ir::Builder;
 	using TOpCode = bloop::bytecode::EOpCode;
 
+	// the subclasses of a node are next to each other, so a type test is a range check
+	enum class ENodeKind : std::uint8_t {
+		nk_block,
+		nk_unnamed_scope,
+		nk_program,
+		nk_while,
+		nk_for,
+		nk_expression_statement,
+		nk_return,
+		nk_variable,
+		nk_const_variable,
+		nk_function,
+		nk_if,
+		nk_continue,
+		nk_break,
+
+		nk_literal,
+		nk_identifier,
+		nk_array,
+		nk_binary,
+		nk_assign,
+		nk_assign_statement,
+		nk_function_call,
+		nk_subscript,
+	};
+
+	// the node type is every kind in [first, last], its subclasses included
+#define BLOOP_NODE_KINDS(first, last) \
+	[[nodiscard]] static constexpr bool IsKind(ENodeKind kind) noexcept { \
+		return kind >= ENodeKind::first && kind <= ENodeKind::last; \
+	}
+#define BLOOP_NODE_KIND(kind) BLOOP_NODE_KINDS(kind, kind)
+
 	struct AbstractSyntaxTree	{
-		AbstractSyntaxTree(bloop::CodePosition cp) : m_oApproximatePosition(cp){}
+		AbstractSyntaxTree(ENodeKind kind, bloop::CodePosition cp) : m_oApproximatePosition(cp), m_eKind(kind) {}
 		virtual ~AbstractSyntaxTree() = default;
 		bloop::CodePosition m_oApproximatePosition;
+		const ENodeKind m_eKind;
 
 		inline void Emit(TBCBuilder& builder, TOpCode insn) const {
 			builder.Emit(insn, { m_oApproximatePosition });
@@ -42,18 +85,34 @@ namespace bloop::ast {
 
 	};
 
+	// nullptr when the node isn't a T, replaces dynamic_cast
+	template<typename T>
+	[[nodiscard]] constexpr T* As(AbstractSyntaxTree* node) noexcept {
+		return node && T::IsKind(node->m_eKind) ? static_cast<T*>(node) : nullptr;
+	}
+	template<typename T>
+	[[nodiscard]] constexpr const T* As(const AbstractSyntaxTree* node) noexcept {
+		return node && T::IsKind(node->m_eKind) ? static_cast<const T*>(node) : nullptr;
+	}
+
 	struct Statement : AbstractSyntaxTree {
-		Statement(bloop::CodePosition cp) : AbstractSyntaxTree(cp){}
+		BLOOP_NODE_KINDS(nk_block, nk_break)
+		Statement(ENodeKind kind, bloop::CodePosition cp) : AbstractSyntaxTree(kind, cp){}
 		virtual void Resolve(TResolver& resolver) = 0;
 		virtual void EmitByteCode(TBCBuilder& builder) = 0;
+		virtual void BuildIR(TIRBuilder& builder) = 0;
+		virtual void Optimize([[maybe_unused]] TOptimizer& optimizer) {}
 		[[nodiscard]] virtual constexpr bool IsFunction() const noexcept { return false; }
 		[[nodiscard]] virtual constexpr bool IsReturn() const noexcept { return false; }
 		[[nodiscard]] virtual constexpr bool IsDeclaration() const noexcept { return false; }
+		[[nodiscard]] virtual constexpr bool IsTerminator() const noexcept { return false; } // nothing after this is reachable
+		[[nodiscard]] virtual bool IsNoOp() const noexcept { return false; } // can be removed after optimization
 
 	};
 
 	struct BlockStatement : Statement {
-		BlockStatement(const bloop::CodePosition& cp) : Statement(cp){}
+		BLOOP_NODE_KINDS(nk_block, nk_for)
+		BlockStatement(const bloop::CodePosition& cp, ENodeKind kind = ENodeKind::nk_block) : Statement(kind, cp){}
 
 
 		virtual void Resolve(TResolver& resolver) override {
@@ -69,12 +128,14 @@ namespace bloop::ast {
 		virtual void EmitByteCode(TBCBuilder& builder) override {
 			std::ranges::for_each(m_oStatements, [&builder](const auto& s) { s->EmitByteCode(builder); });
 		}
+		void BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
 
-		void AddStatement(std::unique_ptr<Statement>&& stmt) {
+		void AddStatement(NodePtr<Statement>&& stmt) {
 			m_oStatements.emplace_back(std::forward<decltype(stmt)>(stmt));
 		}
 		
-		std::vector<std::unique_ptr<Statement>> m_oStatements;
+		std::vector<NodePtr<Statement>> m_oStatements;
 
 	private:
 		void ResolveStatements(TResolver& resolver) {
@@ -93,15 +154,22 @@ namespace bloop::ast {
 		}
 	};
 	struct UnnamedScopeStatement : BlockStatement {
-		UnnamedScopeStatement(const bloop::CodePosition& cp) : BlockStatement(cp) {}
+		BLOOP_NODE_KIND(nk_unnamed_scope)
+		UnnamedScopeStatement(const bloop::CodePosition& cp) : BlockStatement(cp, ENodeKind::nk_unnamed_scope) {}
 	};
 
 	struct IdentifierExpression;
 	struct Expression : AbstractSyntaxTree {
-		Expression(const bloop::CodePosition& cp) : AbstractSyntaxTree(cp) {}
+		BLOOP_NODE_KINDS(nk_literal, nk_subscript)
+		Expression(ENodeKind kind, const bloop::CodePosition& cp) : AbstractSyntaxTree(kind, cp) {}
 
 		virtual void Resolve(TResolver& resolver) = 0;
 		virtual void EmitByteCode(TBCBuilder& builder) = 0;
+		// returns the value of the expression in the function being built
+		[[nodiscard]] virtual bloop::ir::Instruction* BuildIR(TIRBuilder& builder) = 0;
+		virtual void Optimize([[maybe_unused]] TOptimizer& optimizer) {}
+		// returns the replacement of this expression if it can be computed at compile time
+		[[nodiscard]] virtual NodePtr<Expression> Fold([[maybe_unused]] TOptimizer& optimizer) { return nullptr; }
 		[[nodiscard]] virtual constexpr bool IsConst() const noexcept { return false; }
 
 		[[nodiscard]] virtual IdentifierExpression* GetIdentifier() noexcept { return nullptr; }
@@ -109,8 +177,9 @@ namespace bloop::ast {
 	};
 
 	struct ExpressionStatement : Statement {
-		ExpressionStatement(std::unique_ptr<Expression>&& expr, CodePosition cp) 
-			: Statement(cp), m_pExpression(std::forward<decltype(expr)>(expr)){}
+		BLOOP_NODE_KINDS(nk_expression_statement, nk_return)
+		ExpressionStatement(NodePtr<Expression>&& expr, CodePosition cp, ENodeKind kind = ENodeKind::nk_expression_statement)
+			: Statement(kind, cp), m_pExpression(std::forward<decltype(expr)>(expr)){}
 
 		void Resolve(TResolver& resolver) override {
 			return m_pExpression->Resolve(resolver);
@@ -118,18 +187,28 @@ namespace bloop::ast {
 		virtual void EmitByteCode(TBCBuilder& builder) override {
 			return m_pExpression->EmitByteCode(builder);
 		}
+		void BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
 
-		std::unique_ptr<Expression> m_pExpression;
+		NodePtr<Expression> m_pExpression;
 	};
 
+	// owns the arena that every other node is allocated from, the program itself is on the heap
 	struct Program : BlockStatement {
-		Program(const bloop::CodePosition& cp) : BlockStatement(cp) {}
+		BLOOP_NODE_KIND(nk_program)
+		Program(const bloop::CodePosition& cp) : BlockStatement(cp, ENodeKind::nk_program) {}
+		~Program() {
+			m_oStatements.clear(); // before the arena goes
+		}
+
+		Arena m_oArena;
 
 		bloop::BloopIndex m_uNumFunctions{};
 	};
 
 	struct LiteralExpression : Expression {
-		LiteralExpression(const bloop::CodePosition& cp) : Expression(cp) {}
+		BLOOP_NODE_KIND(nk_literal)
+		LiteralExpression(const bloop::CodePosition& cp) : Expression(ENodeKind::nk_literal, cp) {}
 		[[nodiscard]] constexpr bool IsConst() const noexcept override { return true; }
 
 		void Resolve([[maybe_unused]]TResolver& resolver) override {
@@ -139,22 +218,31 @@ namespace bloop::ast {
 			const auto idx = builder.AddConstant(bloop::bytecode::CConstant{ .m_pConstant = m_pConstant, .m_eDataType = m_eDataType });
 			Emit(builder, TOpCode::LOAD_CONST, idx);
 		};
+		[[nodiscard]] bloop::ir::Instruction* BuildIR(TIRBuilder& builder) override;
 
 		bloop::BloopString m_pConstant;
 		bloop::EValueType m_eDataType{};
 	};
 
 	struct IdentifierExpression : Expression {
-		IdentifierExpression(const bloop::CodePosition& cp) : Expression(cp) {}
+		BLOOP_NODE_KIND(nk_identifier)
+		IdentifierExpression(const bloop::CodePosition& cp) : Expression(ENodeKind::nk_identifier, cp) {}
 		[[nodiscard]] IdentifierExpression* GetIdentifier() noexcept override { return this; }
 		using ResolvedIdentifier = bloop::resolver::internal::ResolvedIdentifier;
 		void Resolve(TResolver& resolver) override {
-			m_oResolver = resolver.ResolveIdentifier(m_sName);
+			m_oResolver = resolver.ResolveIdentifier(m_uNameId);
 
 			if(m_oResolver.m_eKind == ResolvedIdentifier::Kind::Error)
 				throw bloop::exception::ResolverError(BLOOPTEXT("unknown identifier: ") + m_sName, m_oApproximatePosition);
 
 			m_bIsConst = m_oResolver.m_bConst;
+
+			if (!m_bIsDirectCallee)
+				resolver.AddFunctionUse(m_oResolver, nullptr);
+
+			// globals can change between calls, direct calls are checked by FunctionCall
+			if (m_oResolver.m_eKind == ResolvedIdentifier::Kind::Global && !m_bIsDirectCallee)
+				resolver.MarkImpure();
 		}
 		void EmitByteCode(TBCBuilder& builder) override {
 			switch (m_oResolver.m_eKind) {
@@ -162,23 +250,37 @@ namespace bloop::ast {
 				Emit(builder, TOpCode::LOAD_LOCAL, m_oResolver.m_uSlot);
 				break;
 			case ResolvedIdentifier::Kind::Upvalue:
-				Emit(builder, TOpCode::LOAD_UPVALUE, m_oResolver.m_uSlot);
+				if (builder.m_oEnclosingSlots)
+					Emit(builder, TOpCode::LOAD_ENCLOSING, builder.m_oEnclosingSlots->m_oUpValues.at(m_oResolver.m_uSlot));
+				else
+					Emit(builder, TOpCode::LOAD_UPVALUE, m_oResolver.m_uSlot);
+				break;
+			case ResolvedIdentifier::Kind::CapturedConst:
+				if (builder.m_oEnclosingSlots)
+					Emit(builder, TOpCode::LOAD_ENCLOSING, builder.m_oEnclosingSlots->m_oConstants.at(m_oResolver.m_uSlot));
+				else
+					Emit(builder, TOpCode::LOAD_CAPTURED_CONST, m_oResolver.m_uSlot);
 				break;
 			case ResolvedIdentifier::Kind::Global:
 				Emit(builder, TOpCode::LOAD_GLOBAL, m_oResolver.m_uSlot);
 				break;
 			}
 		}
+		[[nodiscard]] bloop::ir::Instruction* BuildIR(TIRBuilder& builder) override;
 		[[nodiscard]] constexpr bool IsConst() const noexcept override { return m_bIsConst; }
+		[[nodiscard]] NodePtr<Expression> Fold(TOptimizer& optimizer) override;
 
 		bloop::BloopString m_sName;
+		bloop::BloopNameId m_uNameId{};
 		bloop::BloopBool m_bIsConst{};
+		bloop::BloopBool m_bIsDirectCallee{}; // the use is reported by the call instead
 		bloop::resolver::internal::ResolvedIdentifier m_oResolver{};
 	};
 
 	struct BinaryExpression : Expression {
-		BinaryExpression(const bloop::CodePosition& cp) : Expression(cp) {}
-		BinaryExpression(bloop::EPunctuation punc, const bloop::CodePosition& cp) : Expression(cp), m_ePunctuation(punc){}
+		BLOOP_NODE_KINDS(nk_binary, nk_subscript)
+		BinaryExpression(bloop::EPunctuation punc, const bloop::CodePosition& cp, ENodeKind kind = ENodeKind::nk_binary)
+			: Expression(kind, cp), m_ePunctuation(punc){}
 
 		virtual void Resolve(TResolver& resolver) override {
 			left->Resolve(resolver);
@@ -190,35 +292,45 @@ namespace bloop::ast {
 			left->EmitByteCode(builder);
 			right->EmitByteCode(builder);
 
-			if (!bloop::bytecode::conversionTable.contains(m_ePunctuation))
+			const auto opcode = bloop::bytecode::conversionTable.find(m_ePunctuation);
+			if (opcode == bloop::bytecode::conversionTable.end())
 				throw bloop::exception::ByteCodeError(BLOOPTEXT("unsupported operation"), m_oApproximatePosition);
 
-			Emit(builder, bloop::bytecode::conversionTable[m_ePunctuation]);
+			Emit(builder, opcode->second);
 		}
+		[[nodiscard]] bloop::ir::Instruction* BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
+		[[nodiscard]] NodePtr<Expression> Fold(TOptimizer& optimizer) override;
 
 		bloop::EPunctuation m_ePunctuation{};
-		std::unique_ptr<Expression> left;
-		std::unique_ptr<Expression> right;
+		NodePtr<Expression> left;
+		NodePtr<Expression> right;
 	};
 	struct AssignExpression : BinaryExpression {
-		AssignExpression(const bloop::CodePosition& cp) 
-			: BinaryExpression(bloop::EPunctuation::p_assign, cp) {}
+		BLOOP_NODE_KINDS(nk_assign, nk_assign_statement)
+		AssignExpression(const bloop::CodePosition& cp, ENodeKind kind = ENodeKind::nk_assign)
+			: BinaryExpression(bloop::EPunctuation::p_assign, cp, kind) {}
 
 		void Resolve(TResolver& resolver) override;
 		void EmitByteCode(TBCBuilder& builder) override;
+		[[nodiscard]] bloop::ir::Instruction* BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
+		[[nodiscard]] NodePtr<Expression> Fold([[maybe_unused]] TOptimizer& optimizer) override { return nullptr; }
 		[[nodiscard]] virtual constexpr bool IsStatement() const noexcept { return false; }
 
 	};
 
 	struct AssignStatement : AssignExpression {
-		AssignStatement(const bloop::CodePosition& cp) : AssignExpression(cp) {}
+		BLOOP_NODE_KIND(nk_assign_statement)
+		AssignStatement(const bloop::CodePosition& cp) : AssignExpression(cp, ENodeKind::nk_assign_statement) {}
 		[[nodiscard]] constexpr bool IsStatement() const noexcept override { return true; }
 	};
 
 	struct ArrayExpression : Expression {
 
-		ArrayExpression(std::vector<std::unique_ptr<Expression>>&& inits, const bloop::CodePosition& cp) 
-			: Expression(cp), m_pInitializers(std::forward<decltype(inits)>(inits)) {}
+		BLOOP_NODE_KIND(nk_array)
+		ArrayExpression(std::vector<NodePtr<Expression>>&& inits, const bloop::CodePosition& cp)
+			: Expression(ENodeKind::nk_array, cp), m_pInitializers(std::forward<decltype(inits)>(inits)) {}
 
 		void Resolve(TResolver& resolver) override {
 			for (auto& v : m_pInitializers)
@@ -231,22 +343,28 @@ namespace bloop::ast {
 
 			Emit(builder, TOpCode::CREATE_ARRAY, static_cast<bloop::BloopIndex>(m_pInitializers.size()));
 		}
+		[[nodiscard]] bloop::ir::Instruction* BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
 
-		std::vector<std::unique_ptr<Expression>> m_pInitializers;
+		std::vector<NodePtr<Expression>> m_pInitializers;
 	};
 
 	struct VariableDeclaration : Statement {
-		VariableDeclaration(const bloop::BloopString& name, std::unique_ptr<Expression>&& init, const bloop::CodePosition& cp)
-			: Statement(cp), m_sName(name), m_pExpression(std::forward<decltype(init)>(init)) {}
+		BLOOP_NODE_KINDS(nk_variable, nk_const_variable)
+		VariableDeclaration(const bloop::BloopString& name, bloop::BloopNameId id, NodePtr<Expression>&& init, const bloop::CodePosition& cp,
+			ENodeKind kind = ENodeKind::nk_variable)
+			: Statement(kind, cp), m_sName(name), m_uNameId(id), m_pExpression(std::forward<decltype(init)>(init)) {}
 
 		void Resolve(TResolver& resolver) override {
-			if (resolver.ResolveSymbol(m_sName)) {
+			if (resolver.ResolveSymbol(m_uNameId)) {
 				throw bloop::exception::ResolverError(BLOOPTEXT("variable already declared: ") + m_sName, m_oApproximatePosition);
 			}
 			
 			//prevent a = a by doing this after -> or not lol
-			auto symbol = resolver.DeclareSymbol(m_sName, false);
+			auto symbol = resolver.DeclareSymbol(m_sName, m_uNameId, false);
+			symbol->m_pDeclaration = this;
 			m_uSlot = symbol->m_uSlot;
+			m_bResetsSlot = !m_pExpression && !resolver.m_oFunctions.empty();
 
 			if(m_pExpression)
 				m_pExpression->Resolve(resolver);
@@ -255,23 +373,33 @@ namespace bloop::ast {
 		}
 
 		void EmitByteCode(TBCBuilder& builder) override {
-			if (m_pExpression)
+			if (m_pExpression) {
 				m_pExpression->EmitByteCode(builder);
+			} else if (m_bResetsSlot) {
+				Emit(builder, TOpCode::LOAD_CONST, builder.AddConstant({ .m_pConstant = {}, .m_eDataType = bloop::EValueType::t_undefined }));
+				Emit(builder, TOpCode::STORE_LOCAL, m_uSlot);
+			}
 		}
+		void BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
 
 		[[nodiscard]] virtual constexpr bool IsConst() const noexcept { return false; }
 		[[nodiscard]] constexpr bool IsDeclaration() const noexcept override { return true; }
 
 		bloop::BloopString m_sName;
-		std::unique_ptr<Expression> m_pExpression;
+		bloop::BloopNameId m_uNameId{};
+		NodePtr<Expression> m_pExpression;
 		bloop::BloopIndex m_uSlot{ bloop::INVALID_SLOT };
+		bool m_bResetsSlot{}; // a local without an initializer, the slot can still hold a variable from a closed scope
 	};
 
 	struct ConstVariableDeclaration : VariableDeclaration {
-		ConstVariableDeclaration(const bloop::BloopString& name, std::unique_ptr<Expression>&& init, const bloop::CodePosition& cp)
-			: VariableDeclaration(name, std::forward<decltype(init)>(init), cp){}
+		BLOOP_NODE_KIND(nk_const_variable)
+		ConstVariableDeclaration(const bloop::BloopString& name, bloop::BloopNameId id, NodePtr<Expression>&& init, const bloop::CodePosition& cp)
+			: VariableDeclaration(name, id, std::forward<decltype(init)>(init), cp, ENodeKind::nk_const_variable){}
 
 		[[nodiscard]] constexpr bool IsConst() const noexcept override { return true; }
+		void Optimize(TOptimizer& optimizer) override;
 	};
 
 }
\ No newline at end of file
@@ -5,7 +5,8 @@
 namespace bloop::ast {
 
 	struct WhileStatement : BlockStatement {
-		WhileStatement(const bloop::CodePosition& cp) : BlockStatement(cp) {}
+		BLOOP_NODE_KIND(nk_while)
+		WhileStatement(const bloop::CodePosition& cp) : BlockStatement(cp, ENodeKind::nk_while) {}
 
 		void Resolve(TResolver& resolver) override {
 			m_pCondition->Resolve(resolver);
@@ -35,18 +36,23 @@ namespace bloop::ast {
 
 			builder.m_oLoops.pop_back();
 		}
+		void BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
+		[[nodiscard]] bool IsNoOp() const noexcept override { return m_bNeverRuns; }
 
-		std::unique_ptr<Expression> m_pCondition;
+		NodePtr<Expression> m_pCondition;
+		bool m_bNeverRuns{};
 	};
 
 	struct IfStatement : Statement {
 
 		struct Structure {
-			std::unique_ptr<Expression> m_pCondition;
-			std::unique_ptr<BlockStatement> m_pBody;
+			NodePtr<Expression> m_pCondition;
+			NodePtr<BlockStatement> m_pBody;
 		};
 
-		IfStatement(const CodePosition& cp) : Statement(cp) {}
+		BLOOP_NODE_KIND(nk_if)
+		IfStatement(const CodePosition& cp) : Statement(ENodeKind::nk_if, cp) {}
 
 		void Resolve(TResolver& resolver) override {
 			std::ranges::for_each(m_oIf, [&resolver](std::unique_ptr<Structure>& v) -> void {
@@ -76,8 +82,8 @@ namespace bloop::ast {
 				nextJump = EmitJump(builder, TOpCode::JZ);
 				block->m_pBody->EmitByteCode(builder);
 
-				assert(!block->m_pBody->m_oStatements.empty());
-				const auto lastIsReturn = block->m_pBody->m_oStatements.back()->IsReturn();
+				const auto lastIsReturn = !block->m_pBody->m_oStatements.empty() 
+					&& block->m_pBody->m_oStatements.back()->IsReturn();
 
 				if (jumpRequired && !lastIsReturn)
 					m_oBlockEndJmps.push_back(EmitJump(builder, TOpCode::JMP)); //each block must jump to the end of this chain
@@ -98,15 +104,20 @@ namespace bloop::ast {
 
 
 		}
+		void BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
+		[[nodiscard]] bool IsNoOp() const noexcept override { 
+			return m_oIf.empty() && (!m_pElse || m_pElse->m_oStatements.empty()); 
+		}
+
 		std::vector<std::unique_ptr<Structure>> m_oIf;
-		std::unique_ptr<BlockStatement> m_pElse;
+		NodePtr<BlockStatement> m_pElse;
 
 	};
 
 	struct ForStatement : BlockStatement {
-		[[nodiscard]] constexpr bool IsReturn() const noexcept override { return true; }
-
-		ForStatement(const bloop::CodePosition& cp) : BlockStatement(cp) {}
+		BLOOP_NODE_KIND(nk_for)
+		ForStatement(const bloop::CodePosition& cp) : BlockStatement(cp, ENodeKind::nk_for) {}
 
 		void Resolve(TResolver& resolver) override {
 
@@ -133,6 +144,9 @@ namespace bloop::ast {
 			if (m_pInitializer)
 				m_pInitializer->EmitByteCode(builder);
 
+			if (m_bNeverRuns)
+				return;
+
 			const auto loopStart = builder.m_uOffset;
 
 			if (m_pCondition)
@@ -158,17 +172,23 @@ namespace bloop::ast {
 
 			builder.m_oLoops.pop_back();
 		}
-
-		std::unique_ptr<Statement> m_pInitializer;
-		std::unique_ptr<Expression> m_pCondition;
-		std::unique_ptr<Expression> m_pOnEnd;
+		void BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
+		[[nodiscard]] bool IsNoOp() const noexcept override { return m_bNeverRuns && !m_pInitializer; }
+
+		NodePtr<Statement> m_pInitializer;
+		NodePtr<Expression> m_pCondition;
+		NodePtr<Expression> m_pOnEnd;
+		bool m_bNeverRuns{};
 	};
 
 	struct ReturnStatement : ExpressionStatement {
+		BLOOP_NODE_KIND(nk_return)
 		[[nodiscard]] constexpr bool IsReturn() const noexcept override { return true; }
+		[[nodiscard]] constexpr bool IsTerminator() const noexcept override { return true; }
 
-		ReturnStatement(std::unique_ptr<Expression>&& expr, const bloop::CodePosition& cp) :
-			ExpressionStatement(std::forward<decltype(expr)>(expr), cp) {
+		ReturnStatement(NodePtr<Expression>&& expr, const bloop::CodePosition& cp) :
+			ExpressionStatement(std::forward<decltype(expr)>(expr), cp, ENodeKind::nk_return) {
 		}
 
 		void Resolve(TResolver& resolver) override {
@@ -179,6 +199,10 @@ namespace bloop::ast {
 			if (m_pExpression)
 				ExpressionStatement::Resolve(resolver);
 		}
+		void Optimize(TOptimizer& optimizer) override {
+			if (m_pExpression)
+				ExpressionStatement::Optimize(optimizer);
+		}
 
 		void EmitByteCode(TBCBuilder& builder) override {
 			if (m_pExpression) {
@@ -188,11 +212,14 @@ namespace bloop::ast {
 			}
 			Emit(builder, TOpCode::RETURN);
 		}
+		void BuildIR(TIRBuilder& builder) override;
 
 	};
 
 	struct ContinueStatement : Statement {
-		ContinueStatement(const bloop::CodePosition& cp) : Statement(cp) {}
+		BLOOP_NODE_KIND(nk_continue)
+		ContinueStatement(const bloop::CodePosition& cp) : Statement(ENodeKind::nk_continue, cp) {}
+		[[nodiscard]] constexpr bool IsTerminator() const noexcept override { return true; }
 
 		void Resolve(TResolver& resolver) override {
 			if (!resolver.m_iLoopDepth)
@@ -203,10 +230,13 @@ namespace bloop::ast {
 			assert(builder.m_oLoops.empty() == false);
 			builder.m_oLoops.back().m_oContinueStatements.push_back(EmitJump(builder, TOpCode::JMP));
 		}
+		void BuildIR(TIRBuilder& builder) override;
 	};
 
 	struct BreakStatement : Statement {
-		BreakStatement(const bloop::CodePosition& cp) : Statement(cp) {}
+		BLOOP_NODE_KIND(nk_break)
+		BreakStatement(const bloop::CodePosition& cp) : Statement(ENodeKind::nk_break, cp) {}
+		[[nodiscard]] constexpr bool IsTerminator() const noexcept override { return true; }
 
 		void Resolve(TResolver& resolver) override {
 			if (!resolver.m_iLoopDepth)
@@ -217,5 +247,6 @@ namespace bloop::ast {
 			assert(builder.m_oLoops.empty() == false);
 			builder.m_oLoops.back().m_oBreakStatements.push_back(EmitJump(builder, TOpCode::JMP));
 		}
+		void BuildIR(TIRBuilder& builder) override;
 	};
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "ast/function.hpp"
+#include "ast/postfix.hpp"
 #include "bytecode/defs.hpp"
+#include "ir/builder.hpp"
+#include "ir/lower.hpp"
+#include "ir/passes.hpp"
 
 using namespace bloop::ast;
 #include <iostream>
@@ -17,22 +21,33 @@ inline static auto ConvertCaptures(const auto& captures) {
 
 void FunctionDeclarationStatement::EmitByteCode(TBCBuilder& parent) {
 
-	TBCBuilder fnBuilder(parent.m_oAllFunctions);
+	TBCBuilder fnBuilder(parent.m_oAllFunctions, parent.m_oOutput);
 
-	m_pBody->EmitByteCode(fnBuilder);
+	if (!m_bEscapes) {
+		// every capture is a local of the enclosing function (see Resolver::AnalyzeEscapes)
+		auto& slots = fnBuilder.m_oEnclosingSlots.emplace();
+		for (const auto& cap : m_oCaptures)
+			(cap.m_bByValue ? slots.m_oConstants : slots.m_oUpValues).push_back(cap.m_uSlot);
+	}
+
+	const auto numSlots = EmitBody(fnBuilder);
 	fnBuilder.EnsureReturn(this);
 	PrintInstructions(fnBuilder);
 
 	fnBuilder.m_oAllFunctions[m_uFunctionId] = {
 		.m_sName = m_sName,
 		.m_uParamCount = static_cast<bloop::BloopIndex>(m_oParams.size()),
-		.m_uLocalCount = m_uLocalCount,
+		.m_uLocalCount = numSlots,
 		.chunk = fnBuilder.Finalize(),
 		.m_oCaptures = ConvertCaptures(m_oCaptures)
 	};
 
 	parent.AddFunction(&fnBuilder.m_oAllFunctions[m_uFunctionId]);
 
+	// only called through CALL_ENCLOSED, so there's no value to create
+	if (!m_bEscapes)
+		return;
+
 	if (m_oCaptures.empty()) {
 		Emit(parent, TOpCode::MAKE_FUNCTION, m_uFunctionId);
 	}
@@ -40,7 +55,7 @@ void FunctionDeclarationStatement::EmitByteCode(TBCBuilder& parent) {
 		Emit(parent, TOpCode::MAKE_CLOSURE, m_uFunctionId);
 
 		for (auto& cap : m_oCaptures) {
-			parent.EmitCapture({ cap.kind == Capture::Kind::Local, cap.m_uSlot }, m_oApproximatePosition);
+			parent.EmitCapture(cap.ToBC(), m_oApproximatePosition);
 		}
 	}
 	
@@ -55,8 +70,30 @@ void FunctionDeclarationStatement::EmitByteCode(TBCBuilder& parent) {
 	case ResolvedIdentifier::Kind::Global:
 		Emit(parent, TOpCode::STORE_GLOBAL, m_oIdentifier.m_uSlot);
 		break;
+	case ResolvedIdentifier::Kind::CapturedConst:
+		assert(false); // a function is declared in its own scope, it's never a capture there
+		break;
 	}
 
 
 }
+bloop::BloopIndex FunctionDeclarationStatement::EmitBody(TBCBuilder& fnBuilder) {
+
+	if (!m_pPasses) {
+		m_pBody->EmitByteCode(fnBuilder);
+		return m_uLocalCount;
+	}
+
+	const auto fn = bloop::ir::BuildFunction(this, fnBuilder.m_oEnclosingSlots, m_uInlineThreshold);
+	m_pPasses->Run(*fn);
+	return bloop::ir::Lower(*fn, fnBuilder);
+}
+
+bool FunctionCall::IsDirectCall() const noexcept {
+	return m_pKnownCallee && m_pKnownCallee->m_oParams.size() == m_oArguments.size();
+}
+bloop::BloopIndex FunctionCall::GetDirectFunctionId() const noexcept {
+	assert(IsDirectCall());
+	return m_pKnownCallee->m_uFunctionId;
+}
 
@@ -3,34 +3,49 @@
 #include "ast/ast.hpp"
 #include "utils/fmt.hpp"
 #include <iostream>
+#include <mutex>
+#include <span>
+#include <unordered_set>
+
+namespace bloop::ir {
+	class PassManager;
+}
 
 namespace bloop::ast {
 
 	struct Capture {
 		enum class Kind { Local, Upvalue } kind{};
 		bloop::BloopIndex m_uSlot{};
+		bool m_bByValue{}; // indexes the captured constants instead of the upvalues
 
 		constexpr bloop::bytecode::vmdata::Capture ToBC() const noexcept {
-			return { kind == Kind::Local, m_uSlot };
+			return { kind == Kind::Local, m_uSlot, m_bByValue };
 		}
 	};
 	using Symbol = bloop::resolver::internal::Symbol;
 
 	struct FunctionDeclarationStatement : Statement {
-		FunctionDeclarationStatement(const BloopString& name, std::vector<BloopString>&& params,
-			std::unique_ptr<BlockStatement>&& body, const bloop::CodePosition& cp)
-			: Statement(cp), m_sName(name), m_oParams(std::forward<decltype(params)>(params)), m_pBody(std::forward<decltype(body)>(body)) {
+		BLOOP_NODE_KIND(nk_function)
+		FunctionDeclarationStatement(const BloopString& name, bloop::BloopNameId id, std::vector<BloopString>&& params,
+			std::vector<bloop::BloopNameId>&& paramIds, NodePtr<BlockStatement>&& body, const bloop::CodePosition& cp)
+			: Statement(ENodeKind::nk_function, cp), m_sName(name), m_uNameId(id), m_oParams(std::forward<decltype(params)>(params)),
+			m_oParamIds(std::forward<decltype(paramIds)>(paramIds)), m_pBody(std::forward<decltype(body)>(body)) {
 		}
 		[[nodiscard]] constexpr bool IsFunction() const noexcept override { return true; }
 
 		void Resolve(TResolver& resolver) override {
 
-			if (resolver.ResolveSymbol(m_sName)) {
+			if (resolver.ResolveSymbol(m_uNameId)) {
 				throw bloop::exception::ResolverError(BLOOPTEXT("already declared: ") + m_sName, m_oApproximatePosition);
 			}
 
-			resolver.DeclareSymbol(m_sName, true);
-			m_oIdentifier = resolver.ResolveIdentifier(m_sName);
+			resolver.DeclareSymbol(m_sName, m_uNameId, true)->m_pFunction = this;
+			m_oIdentifier = resolver.ResolveIdentifier(m_uNameId);
+			m_pEnclosingFunction = resolver.m_oFunctions.empty() ? nullptr : resolver.m_oFunctions.back().m_pCurrentFunction;
+
+			// the closure is stored straight to the slot
+			if (m_pEnclosingFunction && m_oIdentifier.m_eKind == bloop::resolver::internal::ResolvedIdentifier::Kind::Local)
+				m_pEnclosingFunction->m_oPinnedSlots.insert(m_oIdentifier.m_uSlot);
 
 			if(resolver.m_oAllFunctions.size() >= bloop::INVALID_SLOT)
 				throw exception::ResolverError(bloop::fmt::format(BLOOPTEXT("the code has more than {} functions"), bloop::INVALID_SLOT), m_oApproximatePosition);
@@ -42,38 +57,45 @@ namespace bloop::ast {
 			resolver.BeginScope();
 			m_iScopeDepth = resolver.m_iScopeDepth;
 
-			std::ranges::for_each(m_oParams, [this, &resolver](const std::string& param) {
-				if (resolver.ResolveSymbol(param))
-					throw bloop::exception::ResolverError(BLOOPTEXT("already declared: ") + param, m_oApproximatePosition);
-				resolver.DeclareSymbol(param);
-			});
+			for (std::size_t i{}; i < m_oParams.size(); i++) {
+				if (resolver.ResolveSymbol(m_oParamIds[i]))
+					throw bloop::exception::ResolverError(BLOOPTEXT("already declared: ") + m_oParams[i], m_oApproximatePosition);
+				resolver.DeclareSymbol(m_oParams[i], m_oParamIds[i]);
+			}
 
 			m_pBody->ResolveNoScopeManagement(resolver);
-			m_uLocalCount = resolver.m_oFunctions.back().m_uNextSlot;
+			m_uLocalCount = resolver.m_oFunctions.back().m_uNumSlots;
 			resolver.EndScope();
 			resolver.m_oFunctions.pop_back();
 		}
 
 		void PrintInstructions(TBCBuilder& parent) {
-			std::cout << bloop::fmt::format(BLOOPTEXT("\n{}: (id: {})\n"), m_sName, m_uFunctionId);
+			parent.m_oOutput << bloop::fmt::format(BLOOPTEXT("\n{}: (id: {})\n"), m_sName, m_uFunctionId);
 			parent.Print();
 		}
 
 		using FunctionContext = bloop::resolver::internal::FunctionContext;
 		using CaptureT = std::unordered_map<const Symbol*, bloop::BloopIndex>;
-		void PropagateCaptureInward(FunctionDeclarationStatement* prevFunc, std::list<FunctionContext>& nextFunctions, const Symbol* symbol) {
+		void PropagateCaptureInward(FunctionDeclarationStatement* prevFunc, std::span<const FunctionContext> nextFunctions, const Symbol* symbol) {
 
 			if(!m_uNextUpValues)
 				m_uNextUpValues = std::make_unique<CaptureT>();
 
+			// upvalues and captured constants have their own index spaces
+			const auto byValue = symbol->IsCapturedByValue();
+			const auto NextIndex = [&] {
+				return static_cast<bloop::BloopIndex>(std::ranges::count_if(m_oCaptures, [byValue](const Capture& c) { 
+					return c.m_bByValue == byValue; }));
+			};
+
 			const auto AddLocal = [&] { 
-				(*m_uNextUpValues)[symbol] = static_cast<bloop::BloopIndex>(m_uNextUpValues->size());
-				m_oCaptures.push_back({ Capture::Kind::Local, symbol->m_uSlot });
+				(*m_uNextUpValues)[symbol] = NextIndex();
+				m_oCaptures.push_back({ Capture::Kind::Local, symbol->m_uSlot, byValue });
 			};
 
 			const auto AddUpvalue = [&](bloop::BloopIndex slot) {
-				(*m_uNextUpValues)[symbol] = static_cast<bloop::BloopIndex>(m_uNextUpValues->size());
-				m_oCaptures.push_back({ Capture::Kind::Upvalue, slot });
+				(*m_uNextUpValues)[symbol] = NextIndex();
+				m_oCaptures.push_back({ Capture::Kind::Upvalue, slot, byValue });
 			};
 
 			if (prevFunc) {
@@ -88,25 +110,51 @@ namespace bloop::ast {
 				AddLocal();
 			}
 
-			nextFunctions.pop_front();
+			nextFunctions = nextFunctions.subspan(1);
 			if(!nextFunctions.empty())
 				return nextFunctions.front().m_pCurrentFunction->PropagateCaptureInward(this, nextFunctions, symbol);
 		}
 
 		void EmitByteCode(TBCBuilder& parent) override;
+		void BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override {
+			m_pBody->Optimize(optimizer);
+			m_pPasses = optimizer.m_pPasses;
+			m_uInlineThreshold = optimizer.m_oOptions.m_bInlineFunctions ? optimizer.m_oOptions.m_uInlineThreshold : 0u;
+		}
+		// goes through the ir when the optimizer asked for it
+		// returns the number of slots the frame needs
+		[[nodiscard]] bloop::BloopIndex EmitBody(TBCBuilder& fnBuilder);
 
 		bloop::BloopString m_sName;
+		bloop::BloopNameId m_uNameId{};
 		std::vector<BloopString> m_oParams;
-		std::unique_ptr<BlockStatement> m_pBody;
+		std::vector<bloop::BloopNameId> m_oParamIds; // the same order as the names
+		NodePtr<BlockStatement> m_pBody;
 
 		bloop::BloopIndex m_uFunctionId{ 0 };
 		bloop::BloopIndex m_uLocalCount{ 0 };
 		bloop::BloopInt m_iScopeDepth{ 0 };
 
 		bloop::resolver::internal::ResolvedIdentifier m_oIdentifier{};
+		FunctionDeclarationStatement* m_pEnclosingFunction{};
+
+		// when false, no closure is ever created and the captures are read from the enclosing frame
+		bloop::BloopBool m_bEscapes{ true };
+
+		// the result only depends on the arguments, see Resolver::AnalyzePurity
+		bloop::BloopBool m_bPure{};
+		bloop::BloopBool m_bMemoize{}; // the vm caches the results, has to be pure
 
 		std::vector<Capture> m_oCaptures;
 		std::unique_ptr<CaptureT> m_uNextUpValues;
+
+		// locals that something else reads from the frame: captures and the slots of nested functions
+		std::unordered_set<bloop::BloopIndex> m_oPinnedSlots;
+		std::shared_ptr<bloop::ir::PassManager> m_pPasses;
+		bloop::BloopUInt m_uInlineThreshold{};
+		std::optional<bloop::BloopUInt> m_oInlineCost; // instructions in the unoptimized ir
+		std::once_flag m_oInlineCostOnce; // the functions are compiled in parallel, see BuildByteCode
 	};
 
 }
\ No newline at end of file
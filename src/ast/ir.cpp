@@ -0,0 +1,266 @@
+#include "ast/ast.hpp"
+#include "ast/postfix.hpp"
+#include "ast/control.hpp"
+#include "ast/function.hpp"
+#include "ir/builder.hpp"
+
+using namespace bloop::ast;
+using bloop::ir::Instruction;
+using bloop::ir::Op;
+using ResolvedIdentifier = bloop::resolver::internal::ResolvedIdentifier;
+
+// loads and stores that go through memory instead of ssa values
+static Instruction* EmitAccess(TIRBuilder& builder, Op op, TOpCode opcode, bloop::BloopIndex idx,
+	const bloop::CodePosition& cp, const std::vector<Instruction*>& operands = {}) {
+	auto insn = builder.Emit(op, cp, operands);
+	insn->m_eOpCode = opcode;
+	insn->m_uIndex = idx;
+	return insn;
+}
+
+void BlockStatement::BuildIR(TIRBuilder& builder) {
+	std::ranges::for_each(m_oStatements, [&builder](const auto& s) { s->BuildIR(builder); });
+}
+void ExpressionStatement::BuildIR(TIRBuilder& builder) {
+	[[maybe_unused]] const auto _ = m_pExpression->BuildIR(builder);
+}
+void VariableDeclaration::BuildIR(TIRBuilder& builder) {
+	if (m_pExpression) {
+		[[maybe_unused]] const auto _ = m_pExpression->BuildIR(builder);
+		return;
+	}
+
+	if (!m_bResetsSlot)
+		return;
+
+	const auto undefined = builder.m_oFunction.GetUndefined();
+	if (builder.IsPinned(builder.LocalSlot(m_uSlot)))
+		EmitAccess(builder, Op::Store, TOpCode::STORE_LOCAL, m_uSlot, m_oApproximatePosition, { undefined });
+	else
+		builder.WriteVariable(builder.LocalSlot(m_uSlot), undefined);
+}
+
+Instruction* LiteralExpression::BuildIR(TIRBuilder& builder) {
+	return builder.m_oFunction.GetConstant({ .m_pConstant = m_pConstant, .m_eDataType = m_eDataType });
+}
+Instruction* IdentifierExpression::BuildIR(TIRBuilder& builder) {
+
+	const auto slot = m_oResolver.m_uSlot;
+
+	switch (m_oResolver.m_eKind) {
+	case ResolvedIdentifier::Kind::Local:
+		if (builder.IsPinned(builder.LocalSlot(slot)))
+			return EmitAccess(builder, Op::Load, TOpCode::LOAD_LOCAL, slot, m_oApproximatePosition);
+		return builder.ReadVariable(builder.LocalSlot(slot));
+	case ResolvedIdentifier::Kind::Upvalue:
+		if (builder.m_oEnclosingSlots)
+			return EmitAccess(builder, Op::Load, TOpCode::LOAD_ENCLOSING, builder.m_oEnclosingSlots->m_oUpValues.at(slot), m_oApproximatePosition);
+		return EmitAccess(builder, Op::Load, TOpCode::LOAD_UPVALUE, slot, m_oApproximatePosition);
+	case ResolvedIdentifier::Kind::CapturedConst:
+		if (builder.m_oEnclosingSlots)
+			return EmitAccess(builder, Op::Load, TOpCode::LOAD_ENCLOSING, builder.m_oEnclosingSlots->m_oConstants.at(slot), m_oApproximatePosition);
+		return EmitAccess(builder, Op::Load, TOpCode::LOAD_CAPTURED_CONST, slot, m_oApproximatePosition);
+	case ResolvedIdentifier::Kind::Global:
+		return EmitAccess(builder, Op::Load, TOpCode::LOAD_GLOBAL, slot, m_oApproximatePosition);
+	case ResolvedIdentifier::Kind::Error:
+		break;
+	}
+
+	throw bloop::exception::ByteCodeError(BLOOPTEXT("unknown identifier: ") + m_sName, m_oApproximatePosition);
+}
+Instruction* BinaryExpression::BuildIR(TIRBuilder& builder) {
+	const auto lhs = left->BuildIR(builder);
+	const auto rhs = right->BuildIR(builder);
+
+	const auto opcode = bloop::bytecode::conversionTable.find(m_ePunctuation);
+	if (opcode == bloop::bytecode::conversionTable.end())
+		throw bloop::exception::ByteCodeError(BLOOPTEXT("unsupported operation"), m_oApproximatePosition);
+
+	auto insn = builder.Emit(Op::Binary, m_oApproximatePosition, { lhs, rhs });
+	insn->m_eOpCode = opcode->second;
+	return insn;
+}
+Instruction* AssignExpression::BuildIR(TIRBuilder& builder) {
+	const auto value = right->BuildIR(builder);
+
+	const auto ptr = left->GetIdentifier();
+	if (!ptr)
+		throw bloop::exception::ResolverError(BLOOPTEXT("lhs wasn't an identifier"), left->m_oApproximatePosition);
+
+	if (As<FunctionCall>(left.get()))
+		throw exception::ResolverError(BLOOPTEXT("invalid lhs operand"), m_oApproximatePosition);
+
+	if (const auto pf = As<Subscript>(left.get())) {
+		const auto arr = pf->left->BuildIR(builder);
+		const auto idx = pf->m_pIndex->BuildIR(builder);
+		auto insn = builder.Emit(Op::SubscriptSet, m_oApproximatePosition, { value, arr, idx });
+		insn->m_eOpCode = TOpCode::SUBSCRIPT_SET;
+		return insn;
+	}
+
+	const auto slot = ptr->m_oResolver.m_uSlot;
+
+	switch (ptr->m_oResolver.m_eKind) {
+	case ResolvedIdentifier::Kind::Local:
+		if (builder.IsPinned(builder.LocalSlot(slot)))
+			EmitAccess(builder, Op::Store, TOpCode::STORE_LOCAL, slot, m_oApproximatePosition, { value });
+		else
+			builder.WriteVariable(builder.LocalSlot(slot), builder.Emit(Op::Copy, m_oApproximatePosition, { value }));
+		break;
+	case ResolvedIdentifier::Kind::Upvalue:
+		if (builder.m_oEnclosingSlots)
+			EmitAccess(builder, Op::Store, TOpCode::STORE_ENCLOSING, builder.m_oEnclosingSlots->m_oUpValues.at(slot), m_oApproximatePosition, { value });
+		else
+			EmitAccess(builder, Op::Store, TOpCode::STORE_UPVALUE, slot, m_oApproximatePosition, { value });
+		break;
+	case ResolvedIdentifier::Kind::Global:
+		EmitAccess(builder, Op::Store, TOpCode::STORE_GLOBAL, slot, m_oApproximatePosition, { value });
+		break;
+	default:
+		throw bloop::exception::ResolverError(BLOOPTEXT("lhs is declared as const"), left->m_oApproximatePosition);
+	}
+
+	return value;
+}
+Instruction* ArrayExpression::BuildIR(TIRBuilder& builder) {
+	std::vector<Instruction*> elements;
+	for (auto& v : m_pInitializers)
+		elements.push_back(v->BuildIR(builder));
+
+	return builder.Emit(Op::Array, m_oApproximatePosition, elements);
+}
+Instruction* FunctionCall::BuildIR(TIRBuilder& builder) {
+	std::vector<Instruction*> operands;
+	for (auto& arg : m_oArguments)
+		operands.push_back(arg->BuildIR(builder));
+
+	if (m_uEnclosedFunction != bloop::INVALID_SLOT) {
+		auto insn = builder.Emit(Op::CallEnclosed, m_oApproximatePosition, operands);
+		insn->m_uIndex = m_uEnclosedFunction;
+		return insn;
+	}
+
+	if (m_pKnownCallee) {
+		if (const auto result = builder.TryInline(m_pKnownCallee, operands, m_oApproximatePosition))
+			return result;
+	}
+
+	if (IsDirectCall()) {
+		auto insn = builder.Emit(Op::CallDirect, m_oApproximatePosition, operands);
+		insn->m_uIndex = GetDirectFunctionId();
+		return insn;
+	}
+
+	operands.push_back(left->BuildIR(builder));
+	return builder.Emit(Op::Call, m_oApproximatePosition, operands);
+}
+Instruction* Subscript::BuildIR(TIRBuilder& builder) {
+	const auto arr = left->BuildIR(builder);
+	const auto idx = m_pIndex->BuildIR(builder);
+	auto insn = builder.Emit(Op::SubscriptGet, m_oApproximatePosition, { arr, idx });
+	insn->m_eOpCode = TOpCode::SUBSCRIPT_GET;
+	return insn;
+}
+
+void WhileStatement::BuildIR(TIRBuilder& builder) {
+	auto& fn = builder.m_oFunction;
+	const auto header = fn.NewBlock();
+	const auto body = fn.NewBlock();
+	const auto exit = fn.NewBlock();
+
+	builder.Jump(header, m_oApproximatePosition);
+	builder.SetCurrent(header);
+	builder.Branch(m_pCondition->BuildIR(builder), body, exit, m_oApproximatePosition);
+	builder.SealBlock(body);
+
+	builder.SetCurrent(body);
+	builder.m_oLoops.push_back({ .m_pBreak = exit, .m_pContinue = header });
+	BlockStatement::BuildIR(builder);
+	builder.m_oLoops.pop_back();
+	builder.Jump(header, m_oApproximatePosition);
+
+	// every jump back to the header is known now
+	builder.SealBlock(header);
+	builder.SealBlock(exit);
+	builder.SetCurrent(exit);
+}
+void IfStatement::BuildIR(TIRBuilder& builder) {
+	auto& fn = builder.m_oFunction;
+	const auto merge = fn.NewBlock();
+
+	for (auto& structure : m_oIf) {
+		const auto then = fn.NewBlock();
+		const auto next = fn.NewBlock();
+
+		builder.Branch(structure->m_pCondition->BuildIR(builder), then, next, m_oApproximatePosition);
+		builder.SealBlock(then);
+		builder.SealBlock(next);
+
+		builder.SetCurrent(then);
+		structure->m_pBody->BuildIR(builder);
+		builder.Jump(merge, m_oApproximatePosition);
+
+		builder.SetCurrent(next);
+	}
+
+	if (m_pElse)
+		m_pElse->BuildIR(builder);
+
+	builder.Jump(merge, m_oApproximatePosition);
+	builder.SealBlock(merge);
+	builder.SetCurrent(merge);
+}
+void ForStatement::BuildIR(TIRBuilder& builder) {
+	if (m_pInitializer)
+		m_pInitializer->BuildIR(builder);
+
+	if (m_bNeverRuns)
+		return;
+
+	auto& fn = builder.m_oFunction;
+	const auto header = fn.NewBlock();
+	const auto body = fn.NewBlock();
+	const auto latch = fn.NewBlock();
+	const auto exit = fn.NewBlock();
+
+	builder.Jump(header, m_oApproximatePosition);
+	builder.SetCurrent(header);
+
+	if (m_pCondition)
+		builder.Branch(m_pCondition->BuildIR(builder), body, exit, m_oApproximatePosition);
+	else
+		builder.Jump(body, m_oApproximatePosition);
+
+	builder.SealBlock(body);
+	builder.SetCurrent(body);
+	builder.m_oLoops.push_back({ .m_pBreak = exit, .m_pContinue = latch });
+	BlockStatement::BuildIR(builder);
+	builder.m_oLoops.pop_back();
+	builder.Jump(latch, m_oApproximatePosition);
+
+	builder.SealBlock(latch);
+	builder.SetCurrent(latch);
+	if (m_pOnEnd)
+		[[maybe_unused]] const auto _ = m_pOnEnd->BuildIR(builder);
+	builder.Jump(header, m_oApproximatePosition);
+
+	builder.SealBlock(header);
+	builder.SealBlock(exit);
+	builder.SetCurrent(exit);
+}
+void ReturnStatement::BuildIR(TIRBuilder& builder) {
+	builder.Return(m_pExpression ? m_pExpression->BuildIR(builder) : nullptr, m_oApproximatePosition);
+}
+void ContinueStatement::BuildIR(TIRBuilder& builder) {
+	assert(builder.m_oLoops.empty() == false);
+	builder.Jump(builder.m_oLoops.back().m_pContinue, m_oApproximatePosition);
+}
+void BreakStatement::BuildIR(TIRBuilder& builder) {
+	assert(builder.m_oLoops.empty() == false);
+	builder.Jump(builder.m_oLoops.back().m_pBreak, m_oApproximatePosition);
+}
+
+void FunctionDeclarationStatement::BuildIR(TIRBuilder& builder) {
+	// lowered by emitting the whole function, which stores itself to its pinned slot
+	builder.Emit(Op::Closure, m_oApproximatePosition)->m_pFunction = this;
+}
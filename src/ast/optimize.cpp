@@ -0,0 +1,174 @@
+#include "ast/ast.hpp"
+#include "ast/control.hpp"
+#include "ast/postfix.hpp"
+#include "ast/function.hpp"
+
+#include <algorithm>
+
+using namespace bloop::ast;
+
+void BlockStatement::Optimize(TOptimizer& optimizer) {
+
+	if (optimizer.m_oOptions.m_bEliminateDeadCode) {
+		// nothing after a return, break or continue can run
+		const auto terminator = std::ranges::find_if(m_oStatements, [](const auto& s) { return s->IsTerminator(); });
+
+		if (terminator != m_oStatements.end() && std::next(terminator) != m_oStatements.end()) {
+			optimizer.m_oReport.m_uRemovedStatements += static_cast<bloop::BloopUInt>(std::distance(std::next(terminator), m_oStatements.end()));
+			m_oStatements.erase(std::next(terminator), m_oStatements.end());
+		}
+	}
+
+	std::ranges::for_each(m_oStatements, [&optimizer](const auto& s) { s->Optimize(optimizer); });
+
+	if (optimizer.m_oOptions.m_bEliminateDeadCode)
+		std::erase_if(m_oStatements, [](const auto& s) { return s->IsNoOp(); });
+}
+
+void ExpressionStatement::Optimize(TOptimizer& optimizer) {
+	optimizer.OptimizeExpression(m_pExpression);
+}
+
+NodePtr<Expression> IdentifierExpression::Fold(TOptimizer& optimizer) {
+	if (m_bIsDirectCallee)
+		return nullptr;
+
+	return optimizer.FindConstant(m_oResolver.m_pDeclaration, m_oApproximatePosition);
+}
+
+void BinaryExpression::Optimize(TOptimizer& optimizer) {
+	optimizer.OptimizeExpression(left);
+	optimizer.OptimizeExpression(right);
+}
+NodePtr<Expression> BinaryExpression::Fold(TOptimizer& optimizer) {
+	const auto l = As<LiteralExpression>(left.get());
+	const auto r = As<LiteralExpression>(right.get());
+
+	if (!l || !r)
+		return nullptr;
+
+	return optimizer.FoldBinary(m_ePunctuation, *l, *r, m_oApproximatePosition);
+}
+
+void AssignExpression::Optimize(TOptimizer& optimizer) {
+	optimizer.OptimizeExpression(right);
+
+	// the target itself has to stay an identifier
+	if (const auto subscript = As<Subscript>(left.get()))
+		subscript->Optimize(optimizer);
+}
+
+void ArrayExpression::Optimize(TOptimizer& optimizer) {
+	for (auto& v : m_pInitializers)
+		optimizer.OptimizeExpression(v);
+}
+
+void FunctionCall::Optimize(TOptimizer& optimizer) {
+	for (auto& arg : m_oArguments)
+		optimizer.OptimizeExpression(arg);
+
+	optimizer.OptimizeExpression(left);
+}
+
+NodePtr<Expression> FunctionCall::Fold(TOptimizer& optimizer) {
+
+	if (!IsDirectCall() || !m_pKnownCallee->m_bPure)
+		return nullptr;
+
+	std::vector<const LiteralExpression*> args;
+	for (const auto& arg : m_oArguments) {
+		const auto literal = As<LiteralExpression>(arg.get());
+		if (!literal)
+			return nullptr;
+		args.push_back(literal);
+	}
+
+	return optimizer.EvaluateCall(m_pKnownCallee, args, m_oApproximatePosition);
+}
+
+void Subscript::Optimize(TOptimizer& optimizer) {
+	optimizer.OptimizeExpression(m_pIndex);
+	optimizer.OptimizeExpression(left);
+}
+
+void VariableDeclaration::Optimize(TOptimizer& optimizer) {
+	optimizer.OptimizeExpression(m_pExpression);
+}
+void ConstVariableDeclaration::Optimize(TOptimizer& optimizer) {
+	VariableDeclaration::Optimize(optimizer);
+
+	const auto assign = As<AssignExpression>(m_pExpression.get());
+	if (!assign)
+		return;
+
+	if (const auto literal = As<LiteralExpression>(assign->right.get()))
+		optimizer.AddConstant(this, literal);
+}
+
+void WhileStatement::Optimize(TOptimizer& optimizer) {
+	optimizer.OptimizeExpression(m_pCondition);
+
+	if (optimizer.m_oOptions.m_bEliminateDeadCode && optimizer.IsTruthy(m_pCondition.get()) == false) {
+		m_bNeverRuns = true;
+		optimizer.m_oReport.m_uRemovedLoops++;
+		return;
+	}
+
+	BlockStatement::Optimize(optimizer);
+}
+
+void IfStatement::Optimize(TOptimizer& optimizer) {
+
+	for (auto& block : m_oIf)
+		optimizer.OptimizeExpression(block->m_pCondition);
+
+	if (optimizer.m_oOptions.m_bEliminateDeadCode) {
+		std::vector<std::unique_ptr<Structure>> reachable;
+
+		for (auto it = m_oIf.begin(); it != m_oIf.end(); ++it) {
+			const auto truthy = optimizer.IsTruthy((*it)->m_pCondition.get());
+
+			if (truthy == false) {
+				optimizer.m_oReport.m_uRemovedBranches++;
+				continue;
+			}
+
+			if (truthy == true) {
+				// always taken, so it acts as the else of whatever is left before it
+				optimizer.m_oReport.m_uRemovedBranches += static_cast<bloop::BloopUInt>(std::distance(std::next(it), m_oIf.end()) + (m_pElse ? 1 : 0));
+				m_pElse = std::move((*it)->m_pBody);
+				break;
+			}
+
+			reachable.emplace_back(std::move(*it));
+		}
+
+		m_oIf = std::move(reachable);
+	}
+
+	for (auto& block : m_oIf)
+		block->m_pBody->Optimize(optimizer);
+
+	if (m_pElse)
+		m_pElse->Optimize(optimizer);
+}
+
+void ForStatement::Optimize(TOptimizer& optimizer) {
+
+	if (m_pInitializer)
+		m_pInitializer->Optimize(optimizer);
+
+	optimizer.OptimizeExpression(m_pCondition);
+
+	if (optimizer.m_oOptions.m_bEliminateDeadCode && m_pCondition && optimizer.IsTruthy(m_pCondition.get()) == false) {
+		// the initializer still runs once
+		m_bNeverRuns = true;
+		m_oStatements.clear();
+		m_pOnEnd.reset();
+		optimizer.m_oReport.m_uRemovedLoops++;
+		return;
+	}
+
+	BlockStatement::Optimize(optimizer);
+	optimizer.OptimizeExpression(m_pOnEnd);
+}
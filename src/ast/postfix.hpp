@@ -4,9 +4,12 @@
 
 namespace bloop::ast {
 
+	struct FunctionDeclarationStatement;
+
 	struct Postfix : BinaryExpression {
 
-		Postfix(EPunctuation punct, const bloop::CodePosition& cp) : BinaryExpression(punct, cp) {}
+		BLOOP_NODE_KINDS(nk_function_call, nk_subscript)
+		Postfix(EPunctuation punct, const bloop::CodePosition& cp, ENodeKind kind) : BinaryExpression(punct, cp, kind) {}
 
 		[[nodiscard]] IdentifierExpression* GetIdentifier() noexcept override {
 
@@ -17,7 +20,7 @@ namespace bloop::ast {
 				if (const auto identifier = _left->GetIdentifier())
 					return identifier;
 
-				auto expr = dynamic_cast<BinaryExpression*>(_left);
+				auto expr = As<BinaryExpression>(_left);
 
 				if (!expr)
 					break;
@@ -32,33 +35,63 @@ namespace bloop::ast {
 
 	struct FunctionCall : Postfix {
 
-		FunctionCall(const bloop::CodePosition& cp) : Postfix(EPunctuation::p_par_open, cp){}
-		FunctionCall(std::vector<std::unique_ptr<Expression>>&& args, const bloop::CodePosition& cp) 
-			: Postfix(EPunctuation::p_par_open, cp), m_oArguments(std::forward<decltype(args)>(args)) {}
+		BLOOP_NODE_KIND(nk_function_call)
+		FunctionCall(std::vector<NodePtr<Expression>>&& args, const bloop::CodePosition& cp)
+			: Postfix(EPunctuation::p_par_open, cp, ENodeKind::nk_function_call), m_oArguments(std::forward<decltype(args)>(args)) {}
 
 		virtual void Resolve(TResolver& resolver) override {
 			for (auto& arg : m_oArguments)
 				arg->Resolve(resolver);
 			
+			auto callee = As<IdentifierExpression>(left.get());
+
+			if (callee)
+				callee->m_bIsDirectCallee = true;
+
 			left->Resolve(resolver);
 
+			if (callee)
+				resolver.AddFunctionUse(callee->m_oResolver, this);
+
+			// global functions are const, so the name always refers to the same function
+			if (callee && callee->m_oResolver.m_eKind == IdentifierExpression::ResolvedIdentifier::Kind::Global && callee->m_oResolver.m_pSymbol)
+				m_pKnownCallee = callee->m_oResolver.m_pSymbol->m_pFunction;
+
+			// the callee could be anything
+			if (!IsDirectCall())
+				resolver.MarkImpure();
 		}
 		virtual void EmitByteCode(TBCBuilder& builder) override {
 			for (auto& arg : m_oArguments)
 				arg->EmitByteCode(builder); // load args
 
+			if (m_uEnclosedFunction != bloop::INVALID_SLOT)
+				return Emit(builder, TOpCode::CALL_ENCLOSED, m_uEnclosedFunction);
+
+			if (IsDirectCall())
+				return Emit(builder, TOpCode::CALL_DIRECT, GetDirectFunctionId());
+
 			left->EmitByteCode(builder); // load operand
 			Emit(builder, TOpCode::CALL, static_cast<bloop::BloopIndex>(m_oArguments.size()));
 		}
+		[[nodiscard]] bloop::ir::Instruction* BuildIR(TIRBuilder& builder) override;
+		void Optimize(TOptimizer& optimizer) override;
+		[[nodiscard]] NodePtr<Expression> Fold(TOptimizer& optimizer) override;
 
-		std::vector<std::unique_ptr<Expression>> m_oArguments;
+		// the callee is known and takes this many arguments, so the runtime checks can be skipped
+		[[nodiscard]] bool IsDirectCall() const noexcept;
+		[[nodiscard]] bloop::BloopIndex GetDirectFunctionId() const noexcept;
+
+		std::vector<NodePtr<Expression>> m_oArguments;
+		bloop::BloopIndex m_uEnclosedFunction{ bloop::INVALID_SLOT }; // callee doesn't escape, see Resolver::AnalyzeEscapes
+		FunctionDeclarationStatement* m_pKnownCallee{}; // when the callee can't be anything else
 	};
 
 	struct Subscript : Postfix {
 
-		Subscript(const bloop::CodePosition& cp) : Postfix(EPunctuation::p_bracket_open, cp) {}
-		Subscript(std::unique_ptr<Expression>&& index, const bloop::CodePosition& cp)
-			: Postfix(EPunctuation::p_bracket_open, cp), m_pIndex(std::forward<decltype(index)>(index)) {
+		BLOOP_NODE_KIND(nk_subscript)
+		Subscript(NodePtr<Expression>&& index, const bloop::CodePosition& cp)
+			: Postfix(EPunctuation::p_bracket_open, cp, ENodeKind::nk_subscript), m_pIndex(std::forward<decltype(index)>(index)) {
 		}
 
 		virtual void Resolve(TResolver& resolver) override {
@@ -74,6 +107,10 @@ namespace bloop::ast {
 			m_pIndex->EmitByteCode(builder); // index
 			Emit(builder, TOpCode::SUBSCRIPT_GET);
 		}
+		[[nodiscard]] bloop::ir::Instruction* BuildIR(TIRBuilder& builder) override;
+
+		void Optimize(TOptimizer& optimizer) override;
+		[[nodiscard]] NodePtr<Expression> Fold([[maybe_unused]] TOptimizer& optimizer) override { return nullptr; }
 
 		void EmitSet(TBCBuilder& builder) {
 			left->EmitByteCode(builder);   // arr
@@ -81,7 +118,7 @@ namespace bloop::ast {
 			Emit(builder, TOpCode::SUBSCRIPT_SET);
 		}
 
-		std::unique_ptr<Expression> m_pIndex;
+		NodePtr<Expression> m_pIndex;
 	};
 
 }
\ No newline at end of file
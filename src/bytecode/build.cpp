@@ -3,22 +3,90 @@
 #include "bytecode/function/bc_function.hpp"
 #include "bytecode/global/bc_global.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
 using namespace bloop::bytecode;
 
-VMByteCode bloop::bytecode::BuildByteCode(bloop::ast::Program* code) {
+VMByteCode bloop::bytecode::BuildByteCode(bloop::ast::Program* code, std::size_t numThreads) {
 
 	CByteCodeGlobals globals(code);
 	auto globalChunk = globals.Generate();
 
+	std::vector<bloop::ast::FunctionDeclarationStatement*> decls;
+	for (const auto& stmt : code->m_oStatements) {
+		if (stmt->IsFunction())
+			decls.push_back(bloop::ast::As<bloop::ast::FunctionDeclarationStatement>(stmt.get()));
+	}
+
+	// every function has its own slot already, so the threads never write to the same one
 	std::vector<vmdata::Function> functions(code->m_uNumFunctions);
 
-	for (const auto& stmt : code->m_oStatements) {
-		if (stmt->IsFunction()) {
-			CByteCodeFunction f(dynamic_cast<bloop::ast::FunctionDeclarationStatement*>(stmt.get()));
-			f.Generate(functions);
+	if (!numThreads)
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	numThreads = std::min(numThreads, decls.size());
+
+	if (numThreads <= 1u) {
+		for (const auto decl : decls)
+			CByteCodeFunction(decl).Generate(functions);
+	} else {
+		std::vector<std::ostringstream> outputs(decls.size());
+		std::vector<std::exception_ptr> errors(decls.size());
+		std::atomic<std::size_t> next{};
+
+		const auto work = [&]() {
+			for (auto i = next++; i < decls.size(); i = next++) {
+				try {
+					CByteCodeFunction(decls[i]).Generate(functions, true, outputs[i]);
+				} catch (...) {
+					errors[i] = std::current_exception();
+				}
+			}
+		};
+
+		{
+			std::vector<std::jthread> workers;
+			for (auto i = 1u; i < numThreads; i++)
+				workers.emplace_back(work);
+			work();
+		}
+
+		// the same listing and the same first error as when compiling one function at a time
+		for (std::size_t i{}; i < decls.size(); i++) {
+			std::cout << outputs[i].view();
+			if (errors[i])
+				std::rethrow_exception(errors[i]);
 		}
 	}
 
-	return { globalChunk, globalChunk.m_uNumGlobals, functions };
+	const auto numGlobals = globalChunk.m_uNumGlobals;
+	VMByteCode byteCode{ .chunk = std::move(globalChunk), .numGlobals = numGlobals, .functions = std::move(functions), .constants = {} };
+	ShareConstants(byteCode);
+	return byteCode;
+}
+void bloop::bytecode::ShareConstants(VMByteCode& byteCode) {
+
+	std::unordered_map<CConstant, ConstantId, CConstantHash> ids;
+
+	const auto Share = [&](vmdata::Chunk& chunk) {
+		chunk.m_oConstantIds.reserve(chunk.m_oConstants.size());
+
+		for (auto& constant : chunk.m_oConstants) {
+			const auto [itr, added] = ids.try_emplace(constant, static_cast<ConstantId>(byteCode.constants.size()));
+			if (added)
+				byteCode.constants.emplace_back(std::move(constant));
+			chunk.m_oConstantIds.push_back(itr->second);
+		}
+
+		chunk.m_oConstants = {};
+	};
 
+	Share(byteCode.chunk);
+	for (auto& func : byteCode.functions)
+		Share(func.chunk);
 }
\ No newline at end of file
@@ -15,6 +15,12 @@ namespace bloop::bytecode{
 
 
 
-	[[nodiscard]] VMByteCode BuildByteCode(bloop::ast::Program* code);
+	// the functions are compiled on numThreads threads (0 = one per core)
+	// the result and the printed listing don't depend on the number of threads
+	[[nodiscard]] VMByteCode BuildByteCode(bloop::ast::Program* code, std::size_t numThreads = 0u);
+
+	// moves the constants of every chunk to one pool, so that the vm creates each of them only once
+	// the chunks keep their own indices, m_oConstantIds maps them to the pool
+	void ShareConstants(VMByteCode& byteCode);
 
 }
\ No newline at end of file
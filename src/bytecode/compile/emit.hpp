@@ -2,8 +2,10 @@
 #include "utils/defs.hpp"
 #include "bytecode/defs.hpp"
 
+#include <iostream>
+#include <unordered_map>
 #include <vector>
-#include <variant>
+#include <optional>
 
 namespace bloop::ast {
 	struct AbstractSyntaxTree;
@@ -12,55 +14,10 @@ namespace bloop::ast {
 namespace bloop::bytecode
 {
 
-	struct Instr0 {
-		EOpCode op;
-	};
-
-	struct Instr1 {
-		EOpCode op;
-		bloop::BloopIndex arg;
-	};
-	using Instruction = std::variant<Instr0, Instr1>;
-
-
-
-	struct CSingularByteCode {		
-		Instruction ins;
-		CInstructionPosition loc; // for runtime error messages
-
-		[[nodiscard]] bloop::BloopIndex GetBytes() const {
-			bloop::BloopIndex result{};
-			std::visit([&](auto&& i) {
-				
-				result = 1u;
-				if (std::is_same_v<Instr1, std::decay_t<decltype(i)>>)
-					result = 1u + sizeof(bloop::BloopIndex);
-
-				}, ins);
-			return result;
-		}
-
-		[[nodiscard]] EOpCode GetOpCode() {
-			EOpCode result{};
-			std::visit([&](auto&& i) {
-				result = i.op;
-			}, ins);
-			return result;
-		}
-
-		[[nodiscard]] bloop::BloopString ToString() const {
-			bloop::BloopString res;
-			std::visit([&](auto&& i) {
-				res = stringConversionTable[i.op];
-
-				if constexpr (std::is_same_v<std::decay_t<decltype(i)>, Instr1>) {
-					res += ", " + std::to_string(i.arg);
-				}
-
-			}, ins);
-
-			return res;
-		}
+	// upvalue/captured constant index -> stack slot of the enclosing frame
+	struct EnclosingSlots {
+		std::vector<bloop::BloopIndex> m_oUpValues;
+		std::vector<bloop::BloopIndex> m_oConstants;
 	};
 
 	//contains the instruction offsets
@@ -70,35 +27,43 @@ namespace bloop::bytecode
 	};
 
 	struct CByteCodeBuilder {
-		CByteCodeBuilder(std::vector<vmdata::Function>& allFuncs) : m_oAllFunctions(allFuncs){}
+		CByteCodeBuilder(std::vector<vmdata::Function>& allFuncs, std::ostream& output = std::cout) : m_oAllFunctions(allFuncs), m_oOutput(output){}
 
 		virtual ~CByteCodeBuilder() = default;
 		[[nodiscard]] virtual constexpr bool GlobalContext() const noexcept { return false; }
 		[[nodiscard]] bloop::BloopIndex AddConstant(CConstant&& c);
 		void Emit(EOpCode opcode, bloop::BloopIndex idx, CodePosition pos);
 		void Emit(EOpCode opcode, CodePosition pos);
-		[[nodiscard]] bloop::BloopIndex EmitJump(EOpCode opcode, CodePosition pos); //returns the index of m_oByteCode
+		[[nodiscard]] bloop::BloopIndex EmitJump(EOpCode opcode, CodePosition pos); //returns the offset of the jump in m_oByteCode
 		void EmitJump(EOpCode opcode, bloop::BloopIndex offset, CodePosition pos);
-		void PatchJump(bloop::BloopIndex src, bloop::BloopIndex dst); //dst indexes m_oByteCode
+		void PatchJump(bloop::BloopIndex src, bloop::BloopIndex dst); //rewrites the target of the jump at src
 		void EmitCapture(const vmdata::Capture& capture, CodePosition pos);
 		void EnsureReturn(bloop::ast::AbstractSyntaxTree* node);
 		void AddFunction(const vmdata::Function* func);
 		[[nodiscard]] inline auto FunctionCount() const noexcept { return m_oFunctions.size(); }
-		[[nodiscard]] vmdata::Chunk Finalize();
+		[[nodiscard]] vmdata::Chunk Finalize(); // moves everything out of the builder
 
-		void Print();
-
-		[[nodiscard]] std::vector<bloop::BloopByte> Encode();
-		[[nodiscard]] std::vector<CInstructionPosition> GetCodePositions();
+		void Print() const;
 
 		std::vector<CConstant> m_oConstants;
-		std::vector<CSingularByteCode> m_oByteCode;
-		bloop::BloopIndex m_uOffset{};
+		std::unordered_map<CConstant, bloop::BloopIndex, CConstantHash> m_oConstantIndices; // to m_oConstants
+
+		// encoded as the instructions are emitted, the operands are little endian
+		std::vector<bloop::BloopByte> m_oByteCode;
+		std::vector<CInstructionPosition> m_oPositions; // one per instruction, in the same order
+		bloop::BloopIndex m_uOffset{}; // the size of m_oByteCode
 
 		std::vector<vmdata::Function>& m_oAllFunctions;
+		std::ostream& m_oOutput; // where Print writes to, the nested functions share it
 		std::vector<LoopContext> m_oLoops;
 
+		// set for functions that don't escape
+		std::optional<EnclosingSlots> m_oEnclosingSlots;
+
 	private:
+		void EmitOperand(bloop::BloopIndex operand);
+		[[nodiscard]] bloop::BloopIndex ReadOperand(std::size_t offset) const noexcept;
+
 		std::vector<const vmdata::Function*> m_oFunctions; // references m_oAllFunctions
 	};
 
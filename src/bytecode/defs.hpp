@@ -2,6 +2,7 @@
 
 #include "lexer/punctuation.hpp"
 
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
@@ -17,7 +18,15 @@ namespace bloop::bytecode
 	struct CConstant {
 		bloop::BloopString m_pConstant;
 		bloop::EValueType m_eDataType{};
+
+		[[nodiscard]] bool operator==(const CConstant&) const = default;
+	};
+	struct CConstantHash {
+		[[nodiscard]] std::size_t operator()(const CConstant& c) const noexcept {
+			return std::hash<bloop::BloopString>{}(c.m_pConstant) * 31u + static_cast<std::size_t>(c.m_eDataType);
+		}
 	};
+	using ConstantId = bloop::BloopUInt32; // index to VMByteCode::constants
 	struct CInstructionPosition {
 		bloop::BloopIndex m_uByteOffset;
 		CodePosition m_oPosition;
@@ -27,9 +36,11 @@ namespace bloop::bytecode
 		struct Capture {
 			bool m_bIsLocal;
 			bloop::BloopIndex m_uSlot{};
+			bool m_bByValue{};
 		};
 		struct Chunk {
-			std::vector<CConstant> m_oConstants;
+			std::vector<CConstant> m_oConstants; // moved to the shared pool by ShareConstants
+			std::vector<ConstantId> m_oConstantIds; // what the chunk's own constant indices map to in the pool
 			bloop::BloopIndex m_uNumGlobals{};
 			std::vector<bloop::BloopByte> m_oByteCode;
 			std::vector<CInstructionPosition> m_oPositions;
@@ -41,6 +52,7 @@ namespace bloop::bytecode
 			bloop::BloopIndex m_uLocalCount{};
 			Chunk chunk;
 			std::vector<Capture> m_oCaptures;
+			bool m_bMemoize{};
 		};
 		
 	
@@ -49,8 +61,10 @@ namespace bloop::bytecode
 		vmdata::Chunk chunk;
 		bloop::BloopIndex numGlobals;
 		std::vector<vmdata::Function> functions;
+		std::vector<CConstant> constants; // every distinct constant of the program, shared by the chunks
 	};
-	static std::unordered_map<EPunctuation, EOpCode> conversionTable = {
+	// const, so that nothing inserts into them while the functions are compiled in parallel
+	static const std::unordered_map<EPunctuation, EOpCode> conversionTable = {
 		{ EPunctuation::p_add, EOpCode::ADD },
 		{ EPunctuation::p_sub, EOpCode::SUB },
 		{ EPunctuation::p_multiplication, EOpCode::MUL },
@@ -58,7 +72,7 @@ namespace bloop::bytecode
 		{ EPunctuation::p_less_equal, EOpCode::LESS_EQUAL },
 	};
 
-	static std::unordered_map<EOpCode, bloop::BloopString> stringConversionTable = {
+	static const std::unordered_map<EOpCode, bloop::BloopString> stringConversionTable = {
 		#define BLOOP_OP(name) { EOpCode::name, #name },
 		#include "opcode.def"
 		#undef BLOOP_OP
@@ -10,20 +10,22 @@ CByteCodeFunction::CByteCodeFunction(bloop::ast::FunctionDeclarationStatement* f
 	: m_pFunc(funcDecl){}
 
 // represents a global level function (depth = 0)
-void CByteCodeFunction::Generate(std::vector<vmdata::Function>& funcs) {
+void CByteCodeFunction::Generate(std::vector<vmdata::Function>& funcs, bool print, std::ostream& output) {
 
-	CByteCodeBuilder b(funcs);
+	CByteCodeBuilder b(funcs, output);
 
-	m_pFunc->m_pBody->EmitByteCode(b);
+	const auto numSlots = m_pFunc->EmitBody(b);
 	b.EnsureReturn(m_pFunc);
 
-	m_pFunc->PrintInstructions(b);
+	if (print)
+		m_pFunc->PrintInstructions(b);
 
 	b.m_oAllFunctions[m_pFunc->m_uFunctionId] = {
 		.m_sName = m_pFunc->m_sName,
 		.m_uParamCount = static_cast<bloop::BloopIndex>(m_pFunc->m_oParams.size()),
-		.m_uLocalCount = m_pFunc->m_uLocalCount,
+		.m_uLocalCount = numSlots,
 		.chunk = b.Finalize(),
-		.m_oCaptures = {}
+		.m_oCaptures = {},
+		.m_bMemoize = m_pFunc->m_bMemoize
 	};
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "bytecode/defs.hpp"
 #include "utils/defs.hpp"
 
+#include <iostream>
+
 namespace bloop::ast {
 	struct FunctionDeclarationStatement;
 }
@@ -14,7 +16,8 @@ namespace bloop::bytecode {
 		CByteCodeFunction() = delete;
 		CByteCodeFunction(bloop::ast::FunctionDeclarationStatement* funcDecl);
 
-		void Generate(std::vector<vmdata::Function>& funcs);
+		// only writes to its own slot in funcs and to the slots of its nested functions
+		void Generate(std::vector<vmdata::Function>& funcs, bool print = true, std::ostream& output = std::cout);
 
 	private:
 		bloop::ast::FunctionDeclarationStatement* m_pFunc;
@@ -16,7 +16,7 @@ vmdata::Chunk CByteCodeGlobals::Generate() {
 	for (auto& stmt : m_pCode->m_oStatements) {
 
 		if (stmt->IsFunction()) {
-			auto func = dynamic_cast<bloop::ast::FunctionDeclarationStatement*>(stmt.get());
+			auto func = bloop::ast::As<bloop::ast::FunctionDeclarationStatement>(stmt.get());
 			stmt->Emit(builder, EOpCode::MAKE_FUNCTION, func->m_uFunctionId);
 			stmt->Emit(builder, EOpCode::STORE_GLOBAL, func->m_oIdentifier.m_uSlot);
 			builder.m_uNumGlobals++;
@@ -33,10 +33,7 @@ vmdata::Chunk CByteCodeGlobals::Generate() {
 	std::cout << "\nglobal:\n";
 	builder.Print();
 
-	return { 
-		.m_oConstants = builder.m_oConstants, 
-		.m_uNumGlobals = builder.m_uNumGlobals, 
-		.m_oByteCode = builder.Encode(),
-		.m_oPositions = builder.GetCodePositions()
-	};
+	auto chunk = builder.Finalize();
+	chunk.m_uNumGlobals = builder.m_uNumGlobals;
+	return chunk;
 }
\ No newline at end of file
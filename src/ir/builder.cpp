@@ -0,0 +1,275 @@
+#include "ir/builder.hpp"
+#include "ast/function.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <ranges>
+#include <utility>
+
+using namespace bloop::ir;
+
+std::unique_ptr<Function> bloop::ir::BuildFunction(bloop::ast::FunctionDeclarationStatement* decl,
+	const std::optional<bloop::bytecode::EnclosingSlots>& enclosingSlots, bloop::BloopUInt inlineThreshold) {
+
+	auto fn = std::make_unique<Function>(decl);
+	fn->m_oPinnedSlots = decl->m_oPinnedSlots;
+	fn->m_uParamCount = static_cast<bloop::BloopIndex>(decl->m_oParams.size());
+
+	Builder builder(*fn, enclosingSlots);
+	builder.m_uInlineThreshold = inlineThreshold;
+
+	// the caller already placed the arguments in the first slots
+	for (const auto i : std::views::iota(bloop::BloopIndex(0), fn->m_uParamCount)) {
+		if (builder.IsPinned(i))
+			continue;
+
+		auto param = fn->NewInstruction(Op::Param, decl->m_oApproximatePosition);
+		param->m_uIndex = i;
+		fn->m_oParams.push_back(param);
+		builder.WriteVariable(i, param);
+	}
+
+	decl->m_pBody->BuildIR(builder);
+
+	if (builder.m_pCurrent)
+		builder.Return(nullptr, decl->m_oApproximatePosition);
+
+	fn->RemoveUnreachableBlocks();
+	return fn;
+}
+
+Builder::Builder(Function& fn, const std::optional<bloop::bytecode::EnclosingSlots>& enclosingSlots)
+	: m_oFunction(fn), m_oEnclosingSlots(enclosingSlots), m_uNextSlot(fn.m_pDeclaration->m_uLocalCount) {
+	m_pCurrent = fn.NewBlock();
+	SealBlock(m_pCurrent);
+}
+
+Instruction* Builder::Emit(Op op, const bloop::CodePosition& cp, const std::vector<Instruction*>& operands) {
+
+	if (!m_pCurrent) {
+		m_pCurrent = m_oFunction.NewBlock();
+		SealBlock(m_pCurrent);
+	}
+
+	auto insn = m_oFunction.NewInstruction(op, cp);
+	for (const auto operand : operands)
+		insn->AddOperand(operand);
+
+	insn->m_pBlock = m_pCurrent;
+	m_pCurrent->m_oInstructions.push_back(insn);
+	return insn;
+}
+void Builder::AddEdge(Block* from, Block* to) {
+	assert(!m_oSealed.contains(to));
+	from->m_oSuccessors.push_back(to);
+	to->m_oPredecessors.push_back(from);
+}
+void Builder::Jump(Block* target, const bloop::CodePosition& cp) {
+	if (!m_pCurrent)
+		return;
+
+	Emit(Op::Jump, cp);
+	AddEdge(m_pCurrent, target);
+	m_pCurrent = nullptr;
+}
+void Builder::Branch(Instruction* condition, Block* ifTrue, Block* ifFalse, const bloop::CodePosition& cp) {
+	if (!m_pCurrent)
+		return;
+
+	Emit(Op::Branch, cp, { condition });
+	AddEdge(m_pCurrent, ifTrue);
+	AddEdge(m_pCurrent, ifFalse);
+	m_pCurrent = nullptr;
+}
+void Builder::Return(Instruction* value, const bloop::CodePosition& cp) {
+
+	// an inlined return continues in the caller
+	if (!m_oInlines.empty()) {
+		const auto& frame = m_oInlines.back();
+		WriteVariable(frame.m_uResultSlot, value ? value : m_oFunction.GetUndefined());
+		return Jump(frame.m_pContinuation, cp);
+	}
+
+	Emit(Op::Return, cp, value ? std::vector<Instruction*>{ value } : std::vector<Instruction*>{});
+	m_pCurrent = nullptr;
+}
+
+void Builder::WriteVariable(bloop::BloopIndex slot, Instruction* value) {
+	if (!m_pCurrent) {
+		m_pCurrent = m_oFunction.NewBlock();
+		SealBlock(m_pCurrent);
+	}
+	m_oCurrentDefs[m_pCurrent][slot] = value;
+}
+Instruction* Builder::ReadVariable(bloop::BloopIndex slot) {
+	if (!m_pCurrent)
+		return m_oFunction.GetUndefined();
+
+	return ReadVariable(slot, m_pCurrent);
+}
+Instruction* Builder::ReadVariable(bloop::BloopIndex slot, Block* block) {
+
+	auto& defs = m_oCurrentDefs[block];
+	if (const auto it = defs.find(slot); it != defs.end()) {
+		auto value = it->second;
+		while (value->m_pReplacement)
+			value = value->m_pReplacement;
+		return it->second = value;
+	}
+
+	return ReadVariableRecursive(slot, block);
+}
+Instruction* Builder::ReadVariableRecursive(bloop::BloopIndex slot, Block* block) {
+
+	Instruction* value{};
+
+	if (!m_oSealed.contains(block)) {
+		// not every predecessor is known yet
+		value = NewPhi(block);
+		m_oIncompletePhis[block][slot] = value;
+	} else if (block->m_oPredecessors.empty()) {
+		value = m_oFunction.GetUndefined();
+	} else if (block->m_oPredecessors.size() == 1u) {
+		value = ReadVariable(slot, block->m_oPredecessors.front());
+	} else {
+		// break cycles with an operandless phi
+		auto phi = NewPhi(block);
+		m_oCurrentDefs[block][slot] = phi;
+		value = AddPhiOperands(slot, phi);
+	}
+
+	m_oCurrentDefs[block][slot] = value;
+	return value;
+}
+Instruction* Builder::NewPhi(Block* block) {
+	auto phi = m_oFunction.NewInstruction(Op::Phi, {});
+	phi->m_pBlock = block;
+	block->m_oPhis.push_back(phi);
+	return phi;
+}
+Instruction* Builder::AddPhiOperands(bloop::BloopIndex slot, Instruction* phi) {
+	m_oFilling.insert(phi);
+	for (const auto pred : phi->m_pBlock->m_oPredecessors)
+		phi->AddOperand(ReadVariable(slot, pred));
+	m_oFilling.erase(phi);
+
+	return TryRemoveTrivialPhi(phi);
+}
+Instruction* Builder::TryRemoveTrivialPhi(Instruction* phi) {
+
+	Instruction* same{};
+	for (const auto operand : phi->m_oOperands) {
+		if (operand == same || operand == phi)
+			continue;
+		if (same)
+			return phi; // merges at least two values
+
+		same = operand;
+	}
+
+	if (!same)
+		same = m_oFunction.GetUndefined();
+
+	auto users = phi->m_oUsers;
+	std::erase(users, phi);
+
+	phi->ReplaceAllUsesWith(same);
+	phi->m_pReplacement = same;
+	m_oFunction.Remove(phi);
+
+	// the users might have become trivial now
+	for (const auto user : users) {
+		// phis that are still missing operands are checked once they have them
+		if (user->m_eOp == Op::Phi && user->m_pBlock && m_oSealed.contains(user->m_pBlock) && !m_oFilling.contains(user))
+			[[maybe_unused]] auto _ = TryRemoveTrivialPhi(user);
+	}
+
+	return same;
+}
+void Builder::SealBlock(Block* block) {
+	m_oSealed.insert(block);
+
+	const auto it = m_oIncompletePhis.find(block);
+	if (it == m_oIncompletePhis.end())
+		return;
+
+	const auto phis = std::move(it->second);
+	m_oIncompletePhis.erase(it);
+
+	for (const auto& [slot, phi] : phis)
+		m_oFilling.insert(phi);
+	for (const auto& [slot, phi] : phis)
+		[[maybe_unused]] auto _ = AddPhiOperands(slot, phi);
+}
+
+bool Builder::CanInline(bloop::ast::FunctionDeclarationStatement* callee, std::size_t numArgs) {
+
+	constexpr auto maxDepth = 4u;
+
+	// a wrong argument count is a runtime error, so the call stays dynamic
+	if (!m_uInlineThreshold || numArgs != callee->m_oParams.size() || m_oInlines.size() >= maxDepth)
+		return false;
+
+	// the locals have to be plain ssa values, nothing may read them from a frame
+	if (!callee->m_oCaptures.empty() || !callee->m_oPinnedSlots.empty())
+		return false;
+
+	// the call has to go through the cache
+	if (callee->m_bMemoize)
+		return false;
+
+	if (callee == m_oFunction.m_pDeclaration || std::ranges::any_of(m_oInlines, [callee](const InlineFrame& f) { return f.m_pCallee == callee; }))
+		return false;
+
+	if (static_cast<std::size_t>(m_uNextSlot) + callee->m_uLocalCount + 1u >= bloop::INVALID_SLOT)
+		return false;
+
+	// another thread may be asking about the same callee
+	std::call_once(callee->m_oInlineCostOnce, [callee]() {
+		const auto body = BuildFunction(callee, std::nullopt);
+		bloop::BloopUInt cost{};
+		for (const auto& block : body->m_oBlocks)
+			cost += static_cast<bloop::BloopUInt>(block->m_oPhis.size() + block->m_oInstructions.size());
+		callee->m_oInlineCost = cost;
+	});
+
+	return *callee->m_oInlineCost <= m_uInlineThreshold;
+}
+
+Instruction* Builder::TryInline(bloop::ast::FunctionDeclarationStatement* callee,
+	const std::vector<Instruction*>& args, const bloop::CodePosition& cp) {
+
+	if (!CanInline(callee, args.size()))
+		return nullptr;
+
+	const auto offset = m_uNextSlot;
+	m_uNextSlot = static_cast<bloop::BloopIndex>(m_uNextSlot + callee->m_uLocalCount + 1u);
+
+	const auto continuation = m_oFunction.NewBlock();
+	m_oInlines.push_back({
+		.m_pCallee = callee,
+		.m_pContinuation = continuation,
+		.m_uSlotOffset = offset,
+		.m_uResultSlot = static_cast<bloop::BloopIndex>(offset + callee->m_uLocalCount)
+	});
+
+	for (const auto i : std::views::iota(0u, args.size()))
+		WriteVariable(static_cast<bloop::BloopIndex>(offset + i), args[i]);
+
+	// break and continue can't leave the callee
+	auto loops = std::exchange(m_oLoops, {});
+	callee->m_pBody->BuildIR(*this);
+	m_oLoops = std::move(loops);
+
+	if (m_pCurrent)
+		Return(nullptr, cp);
+
+	const auto resultSlot = m_oInlines.back().m_uResultSlot;
+	m_oInlines.pop_back();
+
+	SealBlock(continuation);
+	SetCurrent(continuation);
+	return ReadVariable(resultSlot);
+}
+
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ir/ir.hpp"
+#include "bytecode/compile/emit.hpp"
+
+#include <optional>
+
+namespace bloop::ir {
+
+	// builds the ssa form of a function body straight from the resolved ast
+	// Braun et al.: "Simple and Efficient Construction of Static Single Assignment Form"
+	// calls to known functions of at most inlineThreshold instructions are inlined, 0 disables it
+	[[nodiscard]] std::unique_ptr<Function> BuildFunction(bloop::ast::FunctionDeclarationStatement* decl,
+		const std::optional<bloop::bytecode::EnclosingSlots>& enclosingSlots, bloop::BloopUInt inlineThreshold = 0u);
+
+	struct Builder {
+		Builder(Function& fn, const std::optional<bloop::bytecode::EnclosingSlots>& enclosingSlots);
+
+		struct LoopTargets {
+			Block* m_pBreak{};
+			Block* m_pContinue{};
+		};
+
+		// a function body that is being built in place of a call
+		struct InlineFrame {
+			bloop::ast::FunctionDeclarationStatement* m_pCallee{};
+			Block* m_pContinuation{};
+			bloop::BloopIndex m_uSlotOffset{}; // the callee's locals are renamed past the caller's
+			bloop::BloopIndex m_uResultSlot{};
+		};
+
+		// appends to the current block, unreachable code gets a block of its own
+		Instruction* Emit(Op op, const bloop::CodePosition& cp, const std::vector<Instruction*>& operands = {});
+		void Jump(Block* target, const bloop::CodePosition& cp);
+		void Branch(Instruction* condition, Block* ifTrue, Block* ifFalse, const bloop::CodePosition& cp);
+		void Return(Instruction* value, const bloop::CodePosition& cp);
+
+		void SetCurrent(Block* block) noexcept { m_pCurrent = block; }
+		void SealBlock(Block* block);
+
+		// locals that aren't pinned are ssa values instead of frame slots
+		[[nodiscard]] bool IsPinned(bloop::BloopIndex slot) const { return m_oFunction.m_oPinnedSlots.contains(slot); }
+		void WriteVariable(bloop::BloopIndex slot, Instruction* value);
+		[[nodiscard]] Instruction* ReadVariable(bloop::BloopIndex slot);
+		// the slot a resolved local has in the function being built
+		[[nodiscard]] bloop::BloopIndex LocalSlot(bloop::BloopIndex slot) const noexcept {
+			return m_oInlines.empty() ? slot : static_cast<bloop::BloopIndex>(m_oInlines.back().m_uSlotOffset + slot);
+		}
+
+		// returns the result of the call, or nullptr when the callee can't be inlined
+		[[nodiscard]] Instruction* TryInline(bloop::ast::FunctionDeclarationStatement* callee,
+			const std::vector<Instruction*>& args, const bloop::CodePosition& cp);
+
+		Function& m_oFunction;
+		const std::optional<bloop::bytecode::EnclosingSlots>& m_oEnclosingSlots;
+		std::vector<LoopTargets> m_oLoops;
+		std::vector<InlineFrame> m_oInlines;
+		Block* m_pCurrent{};
+		bloop::BloopUInt m_uInlineThreshold{};
+
+	private:
+		void AddEdge(Block* from, Block* to);
+		[[nodiscard]] Instruction* ReadVariable(bloop::BloopIndex slot, Block* block);
+		[[nodiscard]] Instruction* ReadVariableRecursive(bloop::BloopIndex slot, Block* block);
+		[[nodiscard]] Instruction* AddPhiOperands(bloop::BloopIndex slot, Instruction* phi);
+		[[nodiscard]] Instruction* TryRemoveTrivialPhi(Instruction* phi);
+		[[nodiscard]] Instruction* NewPhi(Block* block);
+		[[nodiscard]] bool CanInline(bloop::ast::FunctionDeclarationStatement* callee, std::size_t numArgs);
+
+		bloop::BloopIndex m_uNextSlot{}; // past every slot that is in use
+
+		std::unordered_map<const Block*, std::unordered_map<bloop::BloopIndex, Instruction*>> m_oCurrentDefs;
+		std::unordered_map<const Block*, std::unordered_map<bloop::BloopIndex, Instruction*>> m_oIncompletePhis;
+		std::unordered_set<const Block*> m_oSealed;
+		std::unordered_set<const Instruction*> m_oFilling;
+	};
+}
@@ -0,0 +1,376 @@
+#include "ir/ir.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+
+using namespace bloop::ir;
+using TOpCode = bloop::bytecode::EOpCode;
+
+bool Instruction::IsTerminator() const noexcept {
+	return m_eOp == Op::Jump || m_eOp == Op::Branch || m_eOp == Op::Return;
+}
+bool Instruction::HasValue() const noexcept {
+	switch (m_eOp) {
+	case Op::Store:
+	case Op::Closure:
+	case Op::Jump:
+	case Op::Branch:
+	case Op::Return:
+		return false;
+	default:
+		return true;
+	}
+}
+bool Instruction::HasSideEffects() const noexcept {
+	switch (m_eOp) {
+	case Op::Store:
+	case Op::Call:
+	case Op::CallDirect:
+	case Op::CallEnclosed:
+	case Op::SubscriptSet:
+	case Op::Closure:
+	case Op::Jump:
+	case Op::Branch:
+	case Op::Return:
+		return true;
+	default:
+		return false;
+	}
+}
+bool Instruction::MayThrow() const noexcept {
+	// a runtime error ends the script, so these have to stay even when their result is unused
+	if (m_eOp == Op::SubscriptGet)
+		return m_eOpCode != TOpCode::SUBSCRIPT_GET_UNCHECKED;
+	if (m_eOp != Op::Binary)
+		return false;
+
+	// typed operands are always compatible, only an integer division can still fail
+	switch (m_eOpCode) {
+	case TOpCode::ADD_INT:
+	case TOpCode::SUB_INT:
+	case TOpCode::MUL_INT:
+	case TOpCode::LESS_EQUAL_INT:
+	case TOpCode::ADD_DOUBLE:
+	case TOpCode::SUB_DOUBLE:
+	case TOpCode::MUL_DOUBLE:
+	case TOpCode::DIV_DOUBLE:
+	case TOpCode::LESS_EQUAL_DOUBLE:
+		return false;
+	default:
+		return true;
+	}
+}
+
+void Instruction::AddOperand(Instruction* value) {
+	m_oOperands.push_back(value);
+	value->m_oUsers.push_back(this);
+}
+void Instruction::SetOperand(std::size_t idx, Instruction* value) {
+	auto& users = m_oOperands[idx]->m_oUsers;
+	users.erase(std::ranges::find(users, this));
+	m_oOperands[idx] = value;
+	value->m_oUsers.push_back(this);
+}
+void Instruction::RemoveOperand(std::size_t idx) {
+	auto& users = m_oOperands[idx]->m_oUsers;
+	users.erase(std::ranges::find(users, this));
+	m_oOperands.erase(m_oOperands.begin() + static_cast<std::ptrdiff_t>(idx));
+}
+void Instruction::DropOperands() {
+	while (!m_oOperands.empty())
+		RemoveOperand(m_oOperands.size() - 1u);
+}
+void Instruction::ReplaceAllUsesWith(Instruction* value) {
+	assert(value != this);
+
+	const auto users = m_oUsers;
+	for (const auto user : users) {
+		for (auto& operand : user->m_oOperands) {
+			if (operand == this) {
+				operand = value;
+				value->m_oUsers.push_back(user);
+			}
+		}
+	}
+	m_oUsers.clear();
+}
+
+Instruction* Block::Terminator() const noexcept {
+	if (m_oInstructions.empty() || !m_oInstructions.back()->IsTerminator())
+		return nullptr;
+
+	return m_oInstructions.back();
+}
+std::size_t Block::PredecessorIndex(const Block* pred) const {
+	const auto it = std::ranges::find(m_oPredecessors, pred);
+	assert(it != m_oPredecessors.end());
+	return static_cast<std::size_t>(std::distance(m_oPredecessors.begin(), it));
+}
+
+bool DominatorTree::Dominates(const Block* a, const Block* b) const {
+	for (auto block = b; block; ) {
+		if (block == a)
+			return true;
+
+		const auto it = m_oIdom.find(block);
+		block = it == m_oIdom.end() ? nullptr : it->second;
+	}
+	return false;
+}
+
+Function::Function(bloop::ast::FunctionDeclarationStatement* decl) : m_pDeclaration(decl) {}
+
+Block* Function::NewBlock() {
+	auto& block = m_oBlocks.emplace_back(std::make_unique<Block>());
+	block->m_uId = m_uNextBlockId++;
+	return block.get();
+}
+Instruction* Function::NewInstruction(Op op, const bloop::CodePosition& cp) {
+	auto& insn = m_oInstructions.emplace_back(std::make_unique<Instruction>());
+	insn->m_eOp = op;
+	insn->m_oPosition = cp;
+	insn->m_uId = static_cast<bloop::BloopUInt>(m_oInstructions.size() - 1u);
+	return insn.get();
+}
+Instruction* Function::GetConstant(const bloop::bytecode::CConstant& constant) {
+
+	const auto it = std::ranges::find_if(m_oConstants, [&constant](const Instruction* c) {
+		return c->m_oConstant.m_eDataType == constant.m_eDataType && c->m_oConstant.m_pConstant == constant.m_pConstant;
+	});
+
+	if (it != m_oConstants.end())
+		return *it;
+
+	auto c = NewInstruction(Op::Const, {});
+	c->m_oConstant = constant;
+	m_oConstants.push_back(c);
+	return c;
+}
+Instruction* Function::GetUndefined() {
+	return GetConstant({ .m_pConstant = {}, .m_eDataType = bloop::EValueType::t_undefined });
+}
+
+void Function::Remove(Instruction* insn) {
+	insn->DropOperands();
+
+	if (auto block = insn->m_pBlock) {
+		auto& list = insn->m_eOp == Op::Phi ? block->m_oPhis : block->m_oInstructions;
+		list.erase(std::ranges::find(list, insn));
+		insn->m_pBlock = nullptr;
+	}
+}
+
+void Function::RemoveUnreachableBlocks() {
+
+	const auto order = ReversePostOrder();
+	const std::unordered_set<const Block*> reachable(order.begin(), order.end());
+
+	for (const auto block : order) {
+		for (auto i = block->m_oPredecessors.size(); i-- > 0u; ) {
+			if (reachable.contains(block->m_oPredecessors[i]))
+				continue;
+
+			for (const auto phi : block->m_oPhis)
+				phi->RemoveOperand(i);
+
+			block->m_oPredecessors.erase(block->m_oPredecessors.begin() + static_cast<std::ptrdiff_t>(i));
+		}
+	}
+
+	for (const auto& block : m_oBlocks) {
+		if (reachable.contains(block.get()))
+			continue;
+
+		for (const auto phi : block->m_oPhis)
+			phi->DropOperands();
+		for (const auto insn : block->m_oInstructions)
+			insn->DropOperands();
+	}
+
+	std::erase_if(m_oBlocks, [&reachable](const std::unique_ptr<Block>& b) { return !reachable.contains(b.get()); });
+}
+
+void Function::SplitCriticalEdges() {
+
+	const auto numBlocks = m_oBlocks.size();
+
+	for (const auto i : std::views::iota(0u, numBlocks)) {
+		Block* pred = m_oBlocks[i].get();
+
+		if (pred->m_oSuccessors.size() < 2u)
+			continue;
+
+		for (auto& succ : pred->m_oSuccessors) {
+			if (succ->m_oPhis.empty())
+				continue;
+
+			// the phi copies need a block that only leads to succ
+			const auto terminator = pred->Terminator();
+			auto edge = NewBlock();
+			auto jump = NewInstruction(Op::Jump, terminator->m_oPosition);
+			jump->m_pBlock = edge;
+			edge->m_oInstructions.push_back(jump);
+			edge->m_oPredecessors.push_back(pred);
+			edge->m_oSuccessors.push_back(succ);
+
+			succ->m_oPredecessors[succ->PredecessorIndex(pred)] = edge;
+			succ = edge;
+		}
+	}
+}
+
+std::vector<Block*> Function::ReversePostOrder() const {
+
+	std::vector<Block*> order;
+	std::unordered_set<const Block*> visited;
+	std::vector<std::pair<Block*, std::size_t>> stack{ { Entry(), 0u } };
+	visited.insert(Entry());
+
+	while (!stack.empty()) {
+		auto& [block, next] = stack.back();
+
+		// backwards, so that the first successor ends up right after the block
+		if (next < block->m_oSuccessors.size()) {
+			Block* succ = block->m_oSuccessors[block->m_oSuccessors.size() - ++next];
+			if (visited.insert(succ).second)
+				stack.emplace_back(succ, 0u);
+			continue;
+		}
+
+		order.push_back(block);
+		stack.pop_back();
+	}
+
+	std::ranges::reverse(order);
+	return order;
+}
+
+DominatorTree Function::ComputeDominators() const {
+
+	// Cooper, Harvey and Kennedy: "A Simple, Fast Dominance Algorithm"
+	const auto order = ReversePostOrder();
+	std::unordered_map<const Block*, std::size_t> rpo;
+	for (const auto i : std::views::iota(0u, order.size()))
+		rpo[order[i]] = i;
+
+	std::vector<std::size_t> idom(order.size(), std::numeric_limits<std::size_t>::max());
+	idom[0] = 0u;
+
+	const auto Intersect = [&idom](std::size_t a, std::size_t b) {
+		while (a != b) {
+			while (a > b)
+				a = idom[a];
+			while (b > a)
+				b = idom[b];
+		}
+		return a;
+	};
+
+	for (auto changed = true; changed; ) {
+		changed = false;
+
+		for (const auto i : std::views::iota(1u, order.size())) {
+			auto newIdom = std::numeric_limits<std::size_t>::max();
+
+			for (const auto pred : order[i]->m_oPredecessors) {
+				const auto it = rpo.find(pred);
+				if (it == rpo.end() || idom[it->second] == std::numeric_limits<std::size_t>::max())
+					continue;
+
+				newIdom = newIdom == std::numeric_limits<std::size_t>::max() ? it->second : Intersect(it->second, newIdom);
+			}
+
+			if (newIdom != idom[i]) {
+				idom[i] = newIdom;
+				changed = true;
+			}
+		}
+	}
+
+	DominatorTree tree;
+	for (const auto i : std::views::iota(1u, order.size())) {
+		tree.m_oIdom[order[i]] = order[idom[i]];
+		tree.m_oChildren[order[idom[i]]].push_back(order[i]);
+	}
+
+	std::vector<Block*> stack{ Entry() };
+	while (!stack.empty()) {
+		auto block = stack.back();
+		stack.pop_back();
+		tree.m_oPreOrder.push_back(block);
+
+		if (const auto it = tree.m_oChildren.find(block); it != tree.m_oChildren.end())
+			stack.insert(stack.end(), it->second.rbegin(), it->second.rend());
+	}
+
+	return tree;
+}
+
+std::vector<Loop> Function::FindLoops(const DominatorTree& tree) const {
+
+	std::unordered_map<const Block*, Loop> loops;
+
+	for (const auto block : ReversePostOrder()) {
+		for (const auto succ : block->m_oSuccessors) {
+			if (!tree.Dominates(succ, block))
+				continue;
+
+			// a back edge, walk up from the latch until the header
+			auto& loop = loops[succ];
+			loop.m_pHeader = succ;
+			loop.m_oLatches.push_back(block);
+			loop.m_oBlocks.insert(succ);
+
+			std::vector<const Block*> worklist{ block };
+			while (!worklist.empty()) {
+				const auto b = worklist.back();
+				worklist.pop_back();
+
+				if (!loop.m_oBlocks.insert(b).second)
+					continue;
+
+				worklist.insert(worklist.end(), b->m_oPredecessors.begin(), b->m_oPredecessors.end());
+			}
+		}
+	}
+
+	std::vector<Loop> result;
+	for (auto& [header, loop] : loops)
+		result.emplace_back(std::move(loop));
+
+	// an inner loop is always smaller than the loops around it
+	std::ranges::sort(result, {}, [](const Loop& l) { return l.m_oBlocks.size(); });
+	return result;
+}
+
+Block* Loop::Preheader() const {
+
+	Block* preheader{};
+	for (const auto pred : m_pHeader->m_oPredecessors) {
+		if (Contains(pred))
+			continue;
+		if (preheader)
+			return nullptr;
+
+		preheader = pred;
+	}
+
+	if (!preheader || preheader->m_oSuccessors.size() != 1u)
+		return nullptr;
+
+	return preheader;
+}
+
+std::vector<const Block*> Loop::Exits() const {
+
+	std::vector<const Block*> exits;
+	for (const auto block : m_oBlocks) {
+		const auto terminator = block->Terminator();
+		if ((terminator && terminator->m_eOp == Op::Return)
+			|| std::ranges::any_of(block->m_oSuccessors, [this](const Block* s) { return !Contains(s); }))
+			exits.push_back(block);
+	}
+	return exits;
+}
+
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "utils/defs.hpp"
+#include "bytecode/defs.hpp"
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace bloop::ast {
+	struct FunctionDeclarationStatement;
+}
+
+// mid-level ssa representation of a function body, see ir/builder.hpp and ir/lower.hpp
+namespace bloop::ir {
+
+	struct Block;
+
+	enum class Op : bloop::BloopByte {
+		Const,        // not placed in a block, loaded again at every use
+		Param,        // not placed in a block, the argument in its own frame slot
+		Phi,
+		Copy,         // assignment to a local, removed by copy propagation
+		Load,         // m_eOpCode from m_uIndex (globals, upvalues, captured constants, pinned locals)
+		Store,        // m_eOpCode of the operand to m_uIndex
+		Binary,       // m_eOpCode
+		Array,        // elements...
+		Call,         // arguments..., callee
+		CallDirect,   // arguments..., m_uIndex is the function id of a known global function
+		CallEnclosed, // arguments..., m_uIndex is the function id
+		SubscriptGet, // m_eOpCode of array, index
+		SubscriptSet, // m_eOpCode of value, array, index -> value
+		Closure,      // emits m_pFunction, which stores itself to its pinned slot
+		Jump,         // m_oSuccessors[0]
+		Branch,       // condition ? m_oSuccessors[0] : m_oSuccessors[1]
+		Return,       // optional value
+	};
+
+	struct Instruction {
+		Op m_eOp{};
+		bloop::bytecode::EOpCode m_eOpCode{};
+		bloop::BloopIndex m_uIndex{};
+		std::vector<Instruction*> m_oOperands;
+		std::vector<Instruction*> m_oUsers; // one entry per use
+
+		bloop::bytecode::CConstant m_oConstant; // Op::Const
+		bloop::ast::FunctionDeclarationStatement* m_pFunction{}; // Op::Closure
+
+		Block* m_pBlock{};
+		Instruction* m_pReplacement{}; // removed phis forward to the value that replaced them
+		bloop::CodePosition m_oPosition{};
+		bloop::BloopUInt m_uId{};
+
+		[[nodiscard]] bool IsTerminator() const noexcept;
+		[[nodiscard]] bool HasValue() const noexcept; // leaves a value on the stack when lowered
+		[[nodiscard]] bool HasSideEffects() const noexcept;
+		[[nodiscard]] bool MayThrow() const noexcept;
+
+		void AddOperand(Instruction* value);
+		void SetOperand(std::size_t idx, Instruction* value);
+		void RemoveOperand(std::size_t idx);
+		void DropOperands();
+		void ReplaceAllUsesWith(Instruction* value);
+	};
+
+	struct Block {
+		bloop::BloopUInt m_uId{};
+		std::vector<Instruction*> m_oPhis;
+		std::vector<Instruction*> m_oInstructions; // the last one is the terminator
+		std::vector<Block*> m_oPredecessors;
+		std::vector<Block*> m_oSuccessors;
+
+		[[nodiscard]] Instruction* Terminator() const noexcept;
+		[[nodiscard]] std::size_t PredecessorIndex(const Block* pred) const;
+	};
+
+	struct DominatorTree {
+		std::unordered_map<const Block*, Block*> m_oIdom; // the entry has none
+		std::unordered_map<const Block*, std::vector<Block*>> m_oChildren;
+		std::vector<Block*> m_oPreOrder;
+
+		[[nodiscard]] bool Dominates(const Block* a, const Block* b) const;
+	};
+
+	// a natural loop: everything that reaches a back edge to the header without going through it
+	struct Loop {
+		Block* m_pHeader{};
+		std::vector<Block*> m_oLatches;
+		std::unordered_set<const Block*> m_oBlocks;
+
+		[[nodiscard]] bool Contains(const Block* block) const { return m_oBlocks.contains(block); }
+		// the only block that enters the loop, if it jumps nowhere else
+		[[nodiscard]] Block* Preheader() const;
+		// blocks that leave the loop or the function
+		[[nodiscard]] std::vector<const Block*> Exits() const;
+	};
+
+	struct Function {
+		Function(bloop::ast::FunctionDeclarationStatement* decl);
+
+		[[nodiscard]] Block* NewBlock();
+		[[nodiscard]] Instruction* NewInstruction(Op op, const bloop::CodePosition& cp);
+		[[nodiscard]] Instruction* GetConstant(const bloop::bytecode::CConstant& constant);
+		[[nodiscard]] Instruction* GetUndefined();
+		[[nodiscard]] Block* Entry() const noexcept { return m_oBlocks.front().get(); }
+
+		// unlinks the instruction from its block and its operands
+		void Remove(Instruction* insn);
+
+		void RemoveUnreachableBlocks();
+		// inserts an empty block on every edge from a branch to a block with phis
+		void SplitCriticalEdges();
+
+		[[nodiscard]] std::vector<Block*> ReversePostOrder() const;
+		[[nodiscard]] DominatorTree ComputeDominators() const;
+		// innermost loops first
+		[[nodiscard]] std::vector<Loop> FindLoops(const DominatorTree& tree) const;
+
+		bloop::ast::FunctionDeclarationStatement* m_pDeclaration{};
+		std::vector<std::unique_ptr<Block>> m_oBlocks; // front is the entry
+		std::vector<Instruction*> m_oParams;
+		std::unordered_set<bloop::BloopIndex> m_oPinnedSlots;
+		bloop::BloopIndex m_uParamCount{};
+
+	private:
+		std::vector<std::unique_ptr<Instruction>> m_oInstructions;
+		std::vector<Instruction*> m_oConstants;
+		bloop::BloopUInt m_uNextBlockId{};
+	};
+}
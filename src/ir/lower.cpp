@@ -0,0 +1,481 @@
+#include "ir/lower.hpp"
+#include "ir/ir.hpp"
+#include "bytecode/compile/emit.hpp"
+#include "ast/function.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <list>
+#include <optional>
+#include <ranges>
+
+using namespace bloop::ir;
+using TOpCode = bloop::bytecode::EOpCode;
+
+namespace {
+
+	struct Item {
+		enum class Kind { Op, Load, Store, Closure, Jump } m_eKind{};
+		TOpCode m_eOpCode{};
+		std::optional<bloop::BloopIndex> m_oArg{};
+		const Instruction* m_pValue{}; // loaded/stored value, or the closure
+		const Instruction* m_pCopy{}; // the other end of a phi copy
+		const Block* m_pTarget{};
+		bloop::CodePosition m_oPosition{};
+	};
+	using Items = std::list<Item>;
+
+	class Lowering {
+	public:
+		Lowering(Function& fn, bloop::bytecode::CByteCodeBuilder& builder) : m_oFunction(fn), m_oBuilder(builder) {}
+
+		[[nodiscard]] bloop::BloopIndex Run();
+
+	private:
+		// returns false after demoting values that couldn't stay on the stack
+		[[nodiscard]] bool Stackify(const Block* block);
+		[[nodiscard]] Items::iterator AppendOwnItems(Items& items, const Instruction* insn);
+		void ComputeLiveness();
+		[[nodiscard]] bloop::BloopIndex AllocateSlots();
+		void Emit();
+
+		[[nodiscard]] bool IsStackified(const Instruction* v) const { return m_oStackified.contains(v); }
+		[[nodiscard]] bool HasSlot(const Instruction* v) const;
+		// a phi copy between two values that share a slot
+		[[nodiscard]] bool IsNoOpCopy(const Item& item) const;
+
+		Function& m_oFunction;
+		bloop::bytecode::CByteCodeBuilder& m_oBuilder;
+
+		std::vector<Block*> m_oLayout;
+		std::unordered_set<const Instruction*> m_oStackified;
+		std::unordered_map<const Block*, Items> m_oItems;
+		std::unordered_map<const Instruction*, bloop::BloopIndex> m_oSlots;
+		std::unordered_map<const Block*, std::unordered_set<const Instruction*>> m_oLiveIn;
+		std::unordered_map<const Block*, std::unordered_set<const Instruction*>> m_oLiveOut;
+	};
+}
+
+bloop::BloopIndex bloop::ir::Lower(Function& fn, bloop::bytecode::CByteCodeBuilder& builder) {
+	return Lowering(fn, builder).Run();
+}
+
+bloop::BloopIndex Lowering::Run() {
+
+	m_oFunction.RemoveUnreachableBlocks();
+	m_oFunction.SplitCriticalEdges();
+	m_oLayout = m_oFunction.ReversePostOrder();
+
+	// a value can stay on the stack when its only user comes later in the same block
+	for (const auto block : m_oLayout) {
+		for (const auto insn : block->m_oInstructions) {
+			if (insn->HasValue() && insn->m_oUsers.size() == 1u
+				&& insn->m_oUsers.front()->m_eOp != Op::Phi && insn->m_oUsers.front()->m_pBlock == block)
+				m_oStackified.insert(insn);
+		}
+	}
+
+	while (!std::ranges::all_of(m_oLayout, [this](const Block* b) { return Stackify(b); })) {}
+
+	ComputeLiveness();
+	const auto numSlots = AllocateSlots();
+	Emit();
+	return numSlots;
+}
+
+bool Lowering::HasSlot(const Instruction* v) const {
+	switch (v->m_eOp) {
+	case Op::Const:
+		return false;
+	case Op::Param:
+	case Op::Phi:
+		return !v->m_oUsers.empty();
+	default:
+		return v->HasValue() && !v->m_oUsers.empty() && !IsStackified(v);
+	}
+}
+
+bool Lowering::IsNoOpCopy(const Item& item) const {
+	if (!item.m_pCopy || !HasSlot(item.m_pValue) || !HasSlot(item.m_pCopy))
+		return false;
+
+	return m_oSlots.at(item.m_pValue) == m_oSlots.at(item.m_pCopy);
+}
+
+bool Lowering::Stackify(const Block* block) {
+
+	// the items that compute a value on the stack
+	struct Tree {
+		Items::iterator m_oStart;
+		std::size_t m_uFirstInstruction{};
+	};
+
+	auto& items = m_oItems[block];
+	items.clear();
+
+	std::unordered_map<const Instruction*, Tree> trees;
+	std::unordered_map<const Instruction*, std::size_t> definedAt;
+	std::vector<const Instruction*> stack;
+
+	const auto Demote = [this](const auto& values) {
+		for (const auto v : values)
+			m_oStackified.erase(v);
+	};
+
+	for (const auto idx : std::views::iota(std::size_t{}, block->m_oInstructions.size())) {
+		const auto insn = block->m_oInstructions[idx];
+		const auto& operands = insn->m_oOperands;
+		definedAt[insn] = idx;
+
+		// the operands computed earlier have to be the top of the stack, in order
+		std::vector<const Instruction*> onStack;
+		std::ranges::copy_if(operands, std::back_inserter(onStack), [this](const Instruction* o) { return IsStackified(o); });
+
+		if (onStack.size() > stack.size() || !std::equal(onStack.begin(), onStack.end(), stack.end() - static_cast<std::ptrdiff_t>(onStack.size()))) {
+			Demote(stack);
+			Demote(onStack);
+			return false;
+		}
+
+		std::optional<Items::iterator> start;
+		auto first = idx;
+
+		for (const auto i : std::views::iota(std::size_t{}, operands.size())) {
+			const auto operand = operands[i];
+
+			if (IsStackified(operand)) {
+				const auto& tree = trees.at(operand);
+				if (!start)
+					start = tree.m_oStart;
+				first = std::min(first, tree.m_uFirstInstruction);
+				continue;
+			}
+
+			// other operands are loaded in front of the next value that is already on the stack
+			auto where = items.end();
+			const auto next = std::find_if(operands.begin() + static_cast<std::ptrdiff_t>(i) + 1, operands.end(),
+				[this](const Instruction* o) { return IsStackified(o); });
+
+			if (next != operands.end()) {
+				const auto& tree = trees.at(*next);
+				if (const auto def = definedAt.find(operand); def != definedAt.end() && def->second >= tree.m_uFirstInstruction) {
+					// not stored yet when that value starts
+					Demote(std::vector{ *next });
+					return false;
+				}
+				where = tree.m_oStart;
+			}
+
+			const auto it = items.insert(where, { .m_eKind = Item::Kind::Load, .m_pValue = operand, .m_oPosition = insn->m_oPosition });
+			if (!start)
+				start = it;
+		}
+
+		stack.resize(stack.size() - onStack.size());
+
+		const auto own = AppendOwnItems(items, insn);
+		if (!start)
+			start = own;
+
+		if (!insn->HasValue())
+			continue;
+
+		if (IsStackified(insn)) {
+			stack.push_back(insn);
+			trees[insn] = { *start, first };
+		} else if (!insn->m_oUsers.empty()) {
+			items.push_back({ .m_eKind = Item::Kind::Store, .m_pValue = insn, .m_oPosition = insn->m_oPosition });
+		} else {
+			items.push_back({ .m_eKind = Item::Kind::Op, .m_eOpCode = TOpCode::POP, .m_oPosition = insn->m_oPosition });
+		}
+	}
+
+	if (!stack.empty()) {
+		Demote(stack);
+		return false;
+	}
+
+	return true;
+}
+
+Items::iterator Lowering::AppendOwnItems(Items& items, const Instruction* insn) {
+
+	const auto oldSize = items.size();
+	const auto Append = [&](TOpCode op, std::optional<bloop::BloopIndex> arg = std::nullopt) {
+		items.push_back({ .m_eKind = Item::Kind::Op, .m_eOpCode = op, .m_oArg = arg, .m_oPosition = insn->m_oPosition });
+	};
+	const auto AppendJump = [&](TOpCode op, const Block* target) {
+		items.push_back({ .m_eKind = Item::Kind::Jump, .m_eOpCode = op, .m_pTarget = target, .m_oPosition = insn->m_oPosition });
+	};
+
+	switch (insn->m_eOp) {
+	case Op::Copy:
+		break;
+	case Op::Load:
+	case Op::Store:
+		Append(insn->m_eOpCode, insn->m_uIndex);
+		break;
+	case Op::Binary:
+		Append(insn->m_eOpCode);
+		break;
+	case Op::Array:
+		Append(TOpCode::CREATE_ARRAY, static_cast<bloop::BloopIndex>(insn->m_oOperands.size()));
+		break;
+	case Op::Call:
+		Append(TOpCode::CALL, static_cast<bloop::BloopIndex>(insn->m_oOperands.size() - 1u));
+		break;
+	case Op::CallDirect:
+		Append(TOpCode::CALL_DIRECT, insn->m_uIndex);
+		break;
+	case Op::CallEnclosed:
+		Append(TOpCode::CALL_ENCLOSED, insn->m_uIndex);
+		break;
+	case Op::SubscriptGet:
+	case Op::SubscriptSet:
+		Append(insn->m_eOpCode);
+		break;
+	case Op::Closure:
+		items.push_back({ .m_eKind = Item::Kind::Closure, .m_pValue = insn, .m_oPosition = insn->m_oPosition });
+		break;
+	case Op::Jump: {
+		const auto block = insn->m_pBlock;
+		const auto succ = block->m_oSuccessors.front();
+		const auto pred = succ->PredecessorIndex(block);
+
+		// a parallel copy: every operand is loaded before the first phi is overwritten
+		std::vector<const Instruction*> phis;
+		for (const auto phi : succ->m_oPhis) {
+			if (HasSlot(phi) && phi->m_oOperands[pred] != phi)
+				phis.push_back(phi);
+		}
+		for (const auto phi : phis)
+			items.push_back({ .m_eKind = Item::Kind::Load, .m_pValue = phi->m_oOperands[pred], .m_pCopy = phi, .m_oPosition = insn->m_oPosition });
+		for (const auto phi : phis | std::views::reverse)
+			items.push_back({ .m_eKind = Item::Kind::Store, .m_pValue = phi, .m_pCopy = phi->m_oOperands[pred], .m_oPosition = insn->m_oPosition });
+
+		AppendJump(TOpCode::JMP, succ);
+		break;
+	}
+	case Op::Branch:
+		AppendJump(TOpCode::JZ, insn->m_pBlock->m_oSuccessors[1]);
+		AppendJump(TOpCode::JMP, insn->m_pBlock->m_oSuccessors[0]);
+		break;
+	case Op::Return:
+		Append(insn->m_oOperands.empty() ? TOpCode::RETURN : TOpCode::RETURN_VALUE);
+		break;
+	case Op::Const:
+	case Op::Param:
+	case Op::Phi:
+		assert(false);
+		break;
+	}
+
+	return items.size() == oldSize ? items.end() : std::prev(items.end(), static_cast<std::ptrdiff_t>(items.size() - oldSize));
+}
+
+void Lowering::ComputeLiveness() {
+
+	std::unordered_map<const Block*, std::unordered_set<const Instruction*>> uses, defs;
+
+	for (const auto block : m_oLayout) {
+		auto& blockUses = uses[block];
+		auto& blockDefs = defs[block];
+
+		for (const auto phi : block->m_oPhis)
+			blockDefs.insert(phi);
+
+		for (const auto insn : block->m_oInstructions) {
+			for (const auto operand : insn->m_oOperands) {
+				if (HasSlot(operand) && !blockDefs.contains(operand))
+					blockUses.insert(operand);
+			}
+			if (HasSlot(insn))
+				blockDefs.insert(insn);
+		}
+
+		// the phi copies at the end of the block
+		for (const auto succ : block->m_oSuccessors) {
+			const auto pred = succ->PredecessorIndex(block);
+			for (const auto phi : succ->m_oPhis) {
+				const auto operand = phi->m_oOperands[pred];
+				if (HasSlot(phi) && HasSlot(operand) && !blockDefs.contains(operand))
+					blockUses.insert(operand);
+			}
+		}
+	}
+
+	for (auto changed = true; changed; ) {
+		changed = false;
+
+		for (const auto block : m_oLayout | std::views::reverse) {
+			auto& liveOut = m_oLiveOut[block];
+			for (const auto succ : block->m_oSuccessors) {
+				for (const auto v : m_oLiveIn[succ]) {
+					if (v->m_eOp != Op::Phi || v->m_pBlock != succ)
+						liveOut.insert(v);
+				}
+			}
+
+			auto liveIn = uses[block];
+			for (const auto v : liveOut) {
+				if (!defs[block].contains(v))
+					liveIn.insert(v);
+			}
+
+			if (liveIn.size() != m_oLiveIn[block].size()) {
+				m_oLiveIn[block] = std::move(liveIn);
+				changed = true;
+			}
+		}
+	}
+}
+
+bloop::BloopIndex Lowering::AllocateSlots() {
+
+	bloop::BloopIndex numSlots = m_oFunction.m_uParamCount;
+	std::vector<bool> occupied;
+
+	const auto Occupy = [&](bloop::BloopIndex slot) {
+		if (slot >= occupied.size())
+			occupied.resize(slot + 1u);
+		occupied[slot] = true;
+		numSlots = std::max(numSlots, static_cast<bloop::BloopIndex>(slot + 1u));
+	};
+	const auto Free = [&](bloop::BloopIndex slot) {
+		if (!m_oFunction.m_oPinnedSlots.contains(slot))
+			occupied[slot] = false;
+	};
+	const auto IsFree = [&](bloop::BloopIndex slot) {
+		return slot >= occupied.size() || !occupied[slot];
+	};
+
+	// a phi and the values flowing into it share a slot when they can, so the copy disappears
+	const auto Preferred = [&](const Instruction* v) -> std::optional<bloop::BloopIndex> {
+		const auto& related = v->m_eOp == Op::Phi ? v->m_oOperands : v->m_oUsers;
+		for (const auto other : related) {
+			if (other->m_eOp != Op::Phi && v->m_eOp != Op::Phi)
+				continue;
+			if (const auto it = m_oSlots.find(other); it != m_oSlots.end() && IsFree(it->second))
+				return it->second;
+		}
+		return std::nullopt;
+	};
+
+	const auto Assign = [&](const Instruction* v) {
+		const auto preferred = Preferred(v);
+		const auto slot = preferred ? *preferred
+			: static_cast<bloop::BloopIndex>(std::distance(occupied.begin(), std::ranges::find(occupied, false)));
+		if (slot == bloop::INVALID_SLOT)
+			throw bloop::exception::ByteCodeError(BLOOPTEXT("too many values in a function"), v->m_oPosition);
+		m_oSlots[v] = slot;
+		Occupy(slot);
+	};
+
+	// the arguments are already in their slots
+	for (const auto param : m_oFunction.m_oParams)
+		m_oSlots[param] = param->m_uIndex;
+
+	// ssa values are defined before every use, so walking the dominator tree sees the definitions first
+	for (const auto block : m_oFunction.ComputeDominators().m_oPreOrder) {
+
+		occupied.assign(occupied.size(), false);
+		for (const auto slot : m_oFunction.m_oPinnedSlots)
+			Occupy(slot);
+		for (const auto v : m_oLiveIn[block])
+			Occupy(m_oSlots.at(v));
+
+		const auto& liveOut = m_oLiveOut[block];
+		const auto& instructions = block->m_oInstructions;
+
+		std::unordered_map<const Instruction*, std::size_t> lastUse;
+		for (const auto idx : std::views::iota(std::size_t{}, instructions.size())) {
+			for (const auto operand : instructions[idx]->m_oOperands)
+				lastUse[operand] = idx;
+		}
+		for (const auto succ : block->m_oSuccessors) {
+			const auto pred = succ->PredecessorIndex(block);
+			for (const auto phi : succ->m_oPhis)
+				lastUse[phi->m_oOperands[pred]] = instructions.size(); // the phi copies
+		}
+
+		for (const auto phi : block->m_oPhis) {
+			if (HasSlot(phi))
+				Assign(phi);
+		}
+
+		// a phi that is only used by the copies still needs its slot
+		for (const auto phi : block->m_oPhis) {
+			if (HasSlot(phi) && !liveOut.contains(phi) && !lastUse.contains(phi))
+				Free(m_oSlots.at(phi));
+		}
+
+		for (const auto idx : std::views::iota(std::size_t{}, instructions.size())) {
+			const auto insn = instructions[idx];
+
+			// an operand that dies here can give its slot to the result
+			for (const auto operand : std::unordered_set<const Instruction*>(insn->m_oOperands.begin(), insn->m_oOperands.end())) {
+				if (HasSlot(operand) && !liveOut.contains(operand) && lastUse.at(operand) == idx)
+					Free(m_oSlots.at(operand));
+			}
+
+			if (HasSlot(insn)) {
+				Assign(insn);
+				if (!liveOut.contains(insn) && !lastUse.contains(insn))
+					Free(m_oSlots.at(insn));
+			}
+		}
+	}
+
+	return numSlots;
+}
+
+void Lowering::Emit() {
+
+	std::unordered_map<const Block*, bloop::BloopIndex> offsets;
+	std::vector<std::pair<bloop::BloopIndex, const Block*>> patches;
+
+	for (const auto k : std::views::iota(std::size_t{}, m_oLayout.size())) {
+		const auto block = m_oLayout[k];
+		const Block* next = k + 1u < m_oLayout.size() ? m_oLayout[k + 1u] : nullptr;
+		auto& items = m_oItems[block];
+
+		offsets[block] = m_oBuilder.m_uOffset;
+
+		for (auto it = items.begin(); it != items.end(); ++it) {
+			const auto& item = *it;
+
+			if (IsNoOpCopy(item))
+				continue;
+
+			switch (item.m_eKind) {
+			case Item::Kind::Op:
+				if (item.m_oArg)
+					m_oBuilder.Emit(item.m_eOpCode, *item.m_oArg, item.m_oPosition);
+				else
+					m_oBuilder.Emit(item.m_eOpCode, item.m_oPosition);
+				break;
+			case Item::Kind::Load:
+				if (item.m_pValue->m_eOp == Op::Const)
+					m_oBuilder.Emit(TOpCode::LOAD_CONST, m_oBuilder.AddConstant(bloop::bytecode::CConstant(item.m_pValue->m_oConstant)), item.m_oPosition);
+				else
+					m_oBuilder.Emit(TOpCode::LOAD_LOCAL, m_oSlots.at(item.m_pValue), item.m_oPosition);
+				break;
+			case Item::Kind::Store:
+				m_oBuilder.Emit(TOpCode::STORE_LOCAL, m_oSlots.at(item.m_pValue), item.m_oPosition);
+				break;
+			case Item::Kind::Closure:
+				item.m_pValue->m_pFunction->EmitByteCode(m_oBuilder);
+				break;
+			case Item::Kind::Jump:
+				// falls through to the next block anyway
+				if (item.m_eOpCode == TOpCode::JMP && item.m_pTarget == next && std::next(it) == items.end())
+					break;
+				patches.emplace_back(m_oBuilder.EmitJump(item.m_eOpCode, item.m_oPosition), item.m_pTarget);
+				break;
+			}
+		}
+	}
+
+	for (const auto& [src, target] : patches)
+		m_oBuilder.PatchJump(src, offsets.at(target));
+}
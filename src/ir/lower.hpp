@@ -0,0 +1,17 @@
+#pragma once
+
+#include "utils/defs.hpp"
+
+namespace bloop::bytecode {
+	struct CByteCodeBuilder;
+}
+
+namespace bloop::ir {
+
+	struct Function;
+
+	// emits the function back to stack bytecode
+	// values consumed right away stay on the stack, everything else gets a frame slot
+	// returns the number of slots the frame needs
+	[[nodiscard]] bloop::BloopIndex Lower(Function& fn, bloop::bytecode::CByteCodeBuilder& builder);
+}
@@ -0,0 +1,675 @@
+#include "ir/passes.hpp"
+#include "ir/ir.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+using namespace bloop::ir;
+using TOpCode = bloop::bytecode::EOpCode;
+
+void PassManager::Run(Function& fn) {
+	for (const auto& pass : m_oPasses)
+		pass->Run(fn);
+}
+
+namespace {
+	// loads and stores that name the same memory share a location
+	using Location = std::pair<int, bloop::BloopIndex>;
+
+	[[nodiscard]] Location GetLocation(const Instruction* insn) {
+		switch (insn->m_eOpCode) {
+		case TOpCode::LOAD_GLOBAL:
+		case TOpCode::STORE_GLOBAL:
+			return { 0, insn->m_uIndex };
+		case TOpCode::LOAD_UPVALUE:
+		case TOpCode::STORE_UPVALUE:
+			return { 1, insn->m_uIndex };
+		case TOpCode::LOAD_ENCLOSING:
+		case TOpCode::STORE_ENCLOSING:
+			return { 2, insn->m_uIndex };
+		case TOpCode::LOAD_LOCAL:
+		case TOpCode::STORE_LOCAL:
+			return { 3, insn->m_uIndex };
+		default:
+			return { 4, insn->m_uIndex };
+		}
+	}
+
+	// nothing can write to a captured constant
+	[[nodiscard]] bool IsPure(const Instruction* insn) {
+		return insn->m_eOp == Op::Binary || (insn->m_eOp == Op::Load && insn->m_eOpCode == TOpCode::LOAD_CAPTURED_CONST);
+	}
+	[[nodiscard]] bool ClobbersMemory(const Instruction* insn) {
+		return insn->m_eOp == Op::Call || insn->m_eOp == Op::CallDirect || insn->m_eOp == Op::CallEnclosed || insn->m_eOp == Op::Closure;
+	}
+}
+
+bloop::BloopUInt CopyPropagation::Run(Function& fn) {
+
+	bloop::BloopUInt changes{};
+
+	for (const auto& block : fn.m_oBlocks) {
+		const auto instructions = block->m_oInstructions;
+		for (const auto insn : instructions) {
+			if (insn->m_eOp != Op::Copy)
+				continue;
+
+			insn->ReplaceAllUsesWith(insn->m_oOperands.front());
+			fn.Remove(insn);
+			changes++;
+		}
+	}
+
+	for (auto changed = true; changed; ) {
+		changed = false;
+
+		for (const auto& block : fn.m_oBlocks) {
+			const auto phis = block->m_oPhis;
+			for (const auto phi : phis) {
+
+				Instruction* same{};
+				auto trivial = true;
+				for (const auto operand : phi->m_oOperands) {
+					if (operand == phi || operand == same)
+						continue;
+					if (same) {
+						trivial = false;
+						break;
+					}
+					same = operand;
+				}
+
+				if (!trivial)
+					continue;
+
+				if (!same)
+					same = fn.GetUndefined();
+
+				phi->ReplaceAllUsesWith(same);
+				fn.Remove(phi);
+				changes++;
+				changed = true;
+			}
+		}
+	}
+
+	return changes;
+}
+
+bloop::BloopUInt CommonSubexpressionElimination::Run(Function& fn) {
+
+	using Key = std::tuple<Op, TOpCode, bloop::BloopIndex, std::vector<const Instruction*>>;
+
+	const auto tree = fn.ComputeDominators();
+	bloop::BloopUInt changes{};
+
+	const auto Replace = [&fn, &changes](Instruction* insn, Instruction* with) {
+		insn->ReplaceAllUsesWith(with);
+		fn.Remove(insn);
+		changes++;
+	};
+
+	const auto Visit = [&](const auto& self, Block* block, std::map<Key, Instruction*> available) -> void {
+
+		std::map<Location, Instruction*> locations;
+		std::map<std::pair<const Instruction*, const Instruction*>, Instruction*> subscripts;
+
+		const auto instructions = block->m_oInstructions;
+		for (const auto insn : instructions) {
+
+			if (IsPure(insn)) {
+				Key key{ insn->m_eOp, insn->m_eOpCode, insn->m_uIndex, { insn->m_oOperands.begin(), insn->m_oOperands.end() } };
+				if (const auto it = available.find(key); it != available.end())
+					Replace(insn, it->second);
+				else
+					available.emplace(std::move(key), insn);
+
+			} else if (insn->m_eOp == Op::Load) {
+				const auto loc = GetLocation(insn);
+				if (const auto it = locations.find(loc); it != locations.end())
+					Replace(insn, it->second);
+				else
+					locations[loc] = insn;
+
+			} else if (insn->m_eOp == Op::Store) {
+				locations[GetLocation(insn)] = insn->m_oOperands.front(); // later loads read the stored value
+
+			} else if (insn->m_eOp == Op::SubscriptGet) {
+				const auto key = std::make_pair(insn->m_oOperands[0], insn->m_oOperands[1]);
+				if (const auto it = subscripts.find(key); it != subscripts.end())
+					Replace(insn, it->second);
+				else
+					subscripts[key] = insn;
+
+			} else if (insn->m_eOp == Op::SubscriptSet) {
+				subscripts.clear(); // any array could be the same object
+
+			} else if (ClobbersMemory(insn)) {
+				locations.clear();
+				subscripts.clear();
+			}
+		}
+
+		if (const auto it = tree.m_oChildren.find(block); it != tree.m_oChildren.end()) {
+			for (const auto child : it->second)
+				self(self, child, available);
+		}
+	};
+
+	Visit(Visit, fn.Entry(), {});
+	return changes;
+}
+
+namespace {
+	// t_none is a value that hasn't been reached yet, t_unknown can be anything at runtime
+	enum class StaticType : bloop::BloopByte { t_none, t_int, t_double, t_unknown };
+
+	[[nodiscard]] StaticType Meet(StaticType a, StaticType b) noexcept {
+		if (a == StaticType::t_none)
+			return b;
+		if (b == StaticType::t_none || a == b)
+			return a;
+		return StaticType::t_unknown;
+	}
+
+	struct TypedOpCodes {
+		TOpCode m_eInt;
+		TOpCode m_eDouble;
+		bool m_bArithmetic; // the result has the type of the operands
+	};
+
+	const std::map<TOpCode, TypedOpCodes> typedOpCodes = {
+		{ TOpCode::ADD, { TOpCode::ADD_INT, TOpCode::ADD_DOUBLE, true } },
+		{ TOpCode::SUB, { TOpCode::SUB_INT, TOpCode::SUB_DOUBLE, true } },
+		{ TOpCode::MUL, { TOpCode::MUL_INT, TOpCode::MUL_DOUBLE, true } },
+		{ TOpCode::DIV, { TOpCode::DIV_INT, TOpCode::DIV_DOUBLE, true } },
+		{ TOpCode::LESS_EQUAL, { TOpCode::LESS_EQUAL_INT, TOpCode::LESS_EQUAL_DOUBLE, false } },
+	};
+}
+
+bloop::BloopUInt TypeSpecialization::Run(Function& fn) {
+
+	const auto order = fn.ReversePostOrder();
+	std::unordered_map<const Instruction*, StaticType> types;
+
+	const auto TypeOf = [&types](const Instruction* v) {
+		if (v->m_eOp == Op::Const) {
+			switch (v->m_oConstant.m_eDataType) {
+			case bloop::EValueType::t_int:
+				return StaticType::t_int;
+			case bloop::EValueType::t_double:
+				return StaticType::t_double;
+			default:
+				return StaticType::t_unknown;
+			}
+		}
+
+		const auto it = types.find(v);
+		return it == types.end() ? StaticType::t_none : it->second;
+	};
+
+	const auto Infer = [&TypeOf](const Instruction* insn) {
+		switch (insn->m_eOp) {
+		case Op::Phi: {
+			auto type = StaticType::t_none;
+			for (const auto operand : insn->m_oOperands)
+				type = Meet(type, TypeOf(operand));
+			return type;
+		}
+		case Op::Copy:
+			return TypeOf(insn->m_oOperands[0]);
+		case Op::Binary: {
+			const auto it = typedOpCodes.find(insn->m_eOpCode);
+			if (it == typedOpCodes.end() || !it->second.m_bArithmetic)
+				return StaticType::t_unknown;
+
+			const auto lhs = TypeOf(insn->m_oOperands[0]);
+			const auto rhs = TypeOf(insn->m_oOperands[1]);
+			if (lhs == StaticType::t_none || rhs == StaticType::t_none)
+				return StaticType::t_none;
+			return lhs == rhs ? lhs : StaticType::t_unknown;
+		}
+		default:
+			return StaticType::t_unknown;
+		}
+	};
+
+	// optimistic, a loop phi keeps its type if every value flowing back into it has the same type
+	for (auto changed = true; changed; ) {
+		changed = false;
+
+		for (const auto block : order) {
+			for (const auto list : { &block->m_oPhis, &block->m_oInstructions }) {
+				for (const auto insn : *list) {
+					if (!insn->HasValue())
+						continue;
+
+					const auto type = Infer(insn);
+					if (auto& current = types[insn]; current != type) {
+						current = type;
+						changed = true;
+					}
+				}
+			}
+		}
+	}
+
+	bloop::BloopUInt changes{};
+
+	for (const auto block : order) {
+		for (const auto insn : block->m_oInstructions) {
+			if (insn->m_eOp != Op::Binary)
+				continue;
+
+			const auto it = typedOpCodes.find(insn->m_eOpCode);
+			if (it == typedOpCodes.end())
+				continue;
+
+			const auto type = TypeOf(insn->m_oOperands[0]);
+			if (type != TypeOf(insn->m_oOperands[1]))
+				continue;
+
+			if (type == StaticType::t_int)
+				insn->m_eOpCode = it->second.m_eInt;
+			else if (type == StaticType::t_double)
+				insn->m_eOpCode = it->second.m_eDouble;
+			else
+				continue;
+
+			changes++;
+		}
+	}
+
+	return changes;
+}
+
+bloop::BloopUInt LoopInvariantCodeMotion::Run(Function& fn) {
+
+	const auto tree = fn.ComputeDominators();
+	const auto order = fn.ReversePostOrder();
+	bloop::BloopUInt changes{};
+
+	// inner loops first, so that their hoisted values can move out of the outer loops too
+	for (const auto& loop : fn.FindLoops(tree)) {
+
+		const auto preheader = loop.Preheader();
+		if (!preheader)
+			continue;
+
+		// everything the loop could write to
+		std::set<Location> stores;
+		auto clobbers = false;
+		auto writesArrays = false;
+
+		for (const auto block : loop.m_oBlocks) {
+			for (const auto insn : block->m_oInstructions) {
+				if (insn->m_eOp == Op::Store)
+					stores.insert(GetLocation(insn));
+				else if (insn->m_eOp == Op::SubscriptSet)
+					writesArrays = true;
+				else if (ClobbersMemory(insn))
+					clobbers = true;
+			}
+		}
+
+		const auto CanHoist = [&](const Instruction* insn) {
+			switch (insn->m_eOp) {
+			case Op::Binary:
+			case Op::Copy:
+				return true;
+			case Op::Load:
+				return IsPure(insn) || (!clobbers && !stores.contains(GetLocation(insn)));
+			case Op::SubscriptGet:
+				return !clobbers && !writesArrays;
+			default:
+				return false;
+			}
+		};
+
+		// an error has to stay where it was unless the block runs whenever the loop is entered
+		const auto exits = loop.Exits();
+		const auto AlwaysRuns = [&](const Block* block) {
+			return std::ranges::all_of(exits, [&](const Block* b) { return tree.Dominates(block, b); })
+				&& std::ranges::all_of(loop.m_oLatches, [&](const Block* b) { return tree.Dominates(block, b); });
+		};
+
+		const auto IsInvariant = [&loop](const Instruction* v) {
+			return !v->m_pBlock || !loop.Contains(v->m_pBlock);
+		};
+
+		for (const auto block : order) {
+			if (!loop.Contains(block))
+				continue;
+
+			const auto instructions = block->m_oInstructions;
+			for (const auto insn : instructions) {
+
+				if (insn->m_eOp == Op::Phi || !std::ranges::all_of(insn->m_oOperands, IsInvariant) || !CanHoist(insn))
+					continue;
+
+				if (insn->MayThrow() && !AlwaysRuns(block))
+					continue;
+
+				std::erase(block->m_oInstructions, insn);
+				preheader->m_oInstructions.insert(preheader->m_oInstructions.end() - 1, insn);
+				insn->m_pBlock = preheader;
+				changes++;
+			}
+		}
+	}
+
+	return changes;
+}
+
+bloop::BloopUInt DeadStoreElimination::Run(Function& fn) {
+
+	bloop::BloopUInt changes{};
+
+	for (const auto& block : fn.m_oBlocks) {
+
+		// the successors could read anything, so only stores within a block are tracked
+		std::map<Location, Instruction*> pending;
+
+		const auto instructions = block->m_oInstructions;
+		for (const auto insn : instructions) {
+
+			if (insn->m_eOp == Op::Store) {
+				const auto loc = GetLocation(insn);
+				if (const auto it = pending.find(loc); it != pending.end()) {
+					fn.Remove(it->second);
+					changes++;
+				}
+				pending[loc] = insn;
+
+			} else if (insn->m_eOp == Op::Load) {
+				pending.erase(GetLocation(insn));
+
+			} else if (ClobbersMemory(insn) || insn->m_eOp == Op::Return) {
+				pending.clear();
+			}
+		}
+	}
+
+	return changes;
+}
+
+namespace {
+	// inclusive, a missing bound can be anything
+	struct Range {
+		std::optional<bloop::BloopInt> m_oMin;
+		std::optional<bloop::BloopInt> m_oMax;
+	};
+
+	[[nodiscard]] std::optional<bloop::BloopInt> IntConstant(const Instruction* v) {
+		if (v->m_eOp != Op::Const || v->m_oConstant.m_eDataType != bloop::EValueType::t_int)
+			return std::nullopt;
+
+		bloop::BloopInt value{};
+		std::memcpy(&value, v->m_oConstant.m_pConstant.data(), sizeof(value));
+		return value;
+	}
+
+	[[nodiscard]] std::optional<bloop::BloopInt> Shift(std::optional<bloop::BloopInt> bound, bloop::BloopInt by) {
+		using Limits = std::numeric_limits<bloop::BloopInt>;
+
+		if (!bound || (by > 0 && *bound > Limits::max() - by) || (by < 0 && *bound < Limits::min() - by))
+			return std::nullopt;
+
+		return *bound + by;
+	}
+
+	// v = operand + step, for typed int arithmetic with a constant
+	[[nodiscard]] std::optional<std::pair<const Instruction*, bloop::BloopInt>> ConstantStep(const Instruction* v) {
+		if (v->m_eOp != Op::Binary)
+			return std::nullopt;
+
+		const auto lhs = v->m_oOperands[0];
+		const auto rhs = v->m_oOperands[1];
+
+		if (v->m_eOpCode == TOpCode::ADD_INT) {
+			if (const auto c = IntConstant(rhs))
+				return std::make_pair(lhs, *c);
+			if (const auto c = IntConstant(lhs))
+				return std::make_pair(rhs, *c);
+		} else if (v->m_eOpCode == TOpCode::SUB_INT) {
+			if (const auto c = IntConstant(rhs); c && *c != std::numeric_limits<bloop::BloopInt>::min())
+				return std::make_pair(lhs, -*c);
+		}
+		return std::nullopt;
+	}
+
+	[[nodiscard]] std::optional<bloop::BloopInt> ArrayLength(const Instruction* v, std::size_t depth = 0u) {
+		if (depth > 8u)
+			return std::nullopt;
+
+		switch (v->m_eOp) {
+		case Op::Array:
+			return static_cast<bloop::BloopInt>(v->m_oOperands.size());
+		case Op::Copy:
+			return ArrayLength(v->m_oOperands[0], depth + 1u);
+		case Op::Phi: {
+			std::optional<bloop::BloopInt> length;
+			for (const auto operand : v->m_oOperands) {
+				const auto l = ArrayLength(operand, depth + 1u);
+				if (!l)
+					return std::nullopt;
+				length = length ? std::min(*length, *l) : *l;
+			}
+			return length;
+		}
+		default:
+			return std::nullopt;
+		}
+	}
+
+	// integer ranges of ssa values, from constants, induction variables and the comparisons that guard a block
+	class RangeAnalysis {
+	public:
+		RangeAnalysis(const DominatorTree& tree) : m_oTree(tree) {}
+
+		[[nodiscard]] Range Get(const Instruction* v, const Block* at, std::size_t depth = 0u) const {
+
+			auto range = Guards(v, at);
+			if (depth > 8u)
+				return range;
+
+			const auto structural = Structural(v, at, depth);
+			if (structural.m_oMin)
+				range.m_oMin = range.m_oMin ? std::max(*range.m_oMin, *structural.m_oMin) : structural.m_oMin;
+			if (structural.m_oMax)
+				range.m_oMax = range.m_oMax ? std::min(*range.m_oMax, *structural.m_oMax) : structural.m_oMax;
+			return range;
+		}
+
+	private:
+
+		// an ssa value doesn't change, so a comparison on the only edge into a dominator still holds at 'at'
+		[[nodiscard]] Range Guards(const Instruction* v, const Block* at) const {
+			Range range;
+
+			const auto Min = [&range](bloop::BloopInt value) { range.m_oMin = range.m_oMin ? std::max(*range.m_oMin, value) : value; };
+			const auto Max = [&range](bloop::BloopInt value) { range.m_oMax = range.m_oMax ? std::min(*range.m_oMax, value) : value; };
+
+			for (auto block = at; block; ) {
+				const auto pred = block->m_oPredecessors.size() == 1u ? block->m_oPredecessors.front() : nullptr;
+				const auto terminator = pred && pred != block ? pred->Terminator() : nullptr;
+
+				// both operands of a typed comparison are ints
+				if (terminator && terminator->m_eOp == Op::Branch) {
+					const auto cond = terminator->m_oOperands[0];
+					const auto taken = pred->m_oSuccessors[0] == block;
+
+					if (cond->m_eOp == Op::Binary && cond->m_eOpCode == TOpCode::LESS_EQUAL_INT) {
+						const auto lhs = cond->m_oOperands[0];
+						const auto rhs = cond->m_oOperands[1];
+
+						if (const auto k = IntConstant(rhs); k && lhs == v) {
+							if (taken)
+								Max(*k);
+							else if (const auto min = Shift(k, 1))
+								Min(*min);
+						} else if (const auto k = IntConstant(lhs); k && rhs == v) {
+							if (taken)
+								Min(*k);
+							else if (const auto max = Shift(k, -1))
+								Max(*max);
+						}
+					}
+				}
+
+				const auto it = m_oTree.m_oIdom.find(block);
+				block = it == m_oTree.m_oIdom.end() ? nullptr : it->second;
+			}
+
+			return range;
+		}
+
+		[[nodiscard]] Range Structural(const Instruction* v, const Block* at, std::size_t depth) const {
+
+			if (const auto c = IntConstant(v))
+				return { c, c };
+
+			if (const auto step = ConstantStep(v)) {
+				const auto operand = Get(step->first, at, depth + 1u);
+				return { Shift(operand.m_oMin, step->second), Shift(operand.m_oMax, step->second) };
+			}
+
+			if (v->m_eOp != Op::Phi)
+				return {};
+
+			// phi = phi + c on the back edges, the start values bound it from one side
+			Range range;
+			auto increasing = true;
+			auto decreasing = true;
+			auto first = true;
+
+			for (const auto i : std::views::iota(std::size_t{}, v->m_oOperands.size())) {
+				const auto operand = v->m_oOperands[i];
+
+				if (const auto step = ConstantStep(operand); step && step->first == v) {
+					// the step must not overflow anywhere it runs
+					const auto guards = Guards(v, operand->m_pBlock);
+					if (step->second >= 0 && !Shift(guards.m_oMax, step->second))
+						return {};
+					if (step->second <= 0 && !Shift(guards.m_oMin, step->second))
+						return {};
+
+					increasing &= step->second >= 0;
+					decreasing &= step->second <= 0;
+					continue;
+				}
+
+				const auto start = Get(operand, v->m_pBlock->m_oPredecessors[i], depth + 1u);
+				if (first) {
+					range = start;
+					first = false;
+					continue;
+				}
+
+				range.m_oMin = range.m_oMin && start.m_oMin ? std::optional(std::min(*range.m_oMin, *start.m_oMin)) : std::nullopt;
+				range.m_oMax = range.m_oMax && start.m_oMax ? std::optional(std::max(*range.m_oMax, *start.m_oMax)) : std::nullopt;
+			}
+
+			if (first)
+				return {};
+			if (!decreasing)
+				range.m_oMax = std::nullopt;
+			if (!increasing)
+				range.m_oMin = std::nullopt;
+			return range;
+		}
+
+		const DominatorTree& m_oTree;
+	};
+}
+
+bloop::BloopUInt BoundsCheckElimination::Run(Function& fn) {
+
+	const auto tree = fn.ComputeDominators();
+	const RangeAnalysis ranges(tree);
+	bloop::BloopUInt changes{};
+
+	for (const auto& block : fn.m_oBlocks) {
+		for (const auto insn : block->m_oInstructions) {
+
+			const Instruction* array{};
+			const Instruction* index{};
+
+			if (insn->m_eOp == Op::SubscriptGet && insn->m_eOpCode == TOpCode::SUBSCRIPT_GET) {
+				array = insn->m_oOperands[0];
+				index = insn->m_oOperands[1];
+			} else if (insn->m_eOp == Op::SubscriptSet && insn->m_eOpCode == TOpCode::SUBSCRIPT_SET) {
+				array = insn->m_oOperands[1];
+				index = insn->m_oOperands[2];
+			} else {
+				continue;
+			}
+
+			const auto length = ArrayLength(array);
+			if (!length)
+				continue;
+
+			// a bound only exists for a value that is known to be an int
+			const auto range = ranges.Get(index, block.get());
+			if (!range.m_oMin || !range.m_oMax || *range.m_oMin < 0 || *range.m_oMax >= *length)
+				continue;
+
+			insn->m_eOpCode = insn->m_eOp == Op::SubscriptGet ? TOpCode::SUBSCRIPT_GET_UNCHECKED : TOpCode::SUBSCRIPT_SET_UNCHECKED;
+			changes++;
+		}
+	}
+
+	return changes;
+}
+
+bloop::BloopUInt DeadCodeElimination::Run(Function& fn) {
+
+	std::unordered_set<const Instruction*> live;
+	std::vector<const Instruction*> worklist;
+
+	for (const auto& block : fn.m_oBlocks) {
+		for (const auto insn : block->m_oInstructions) {
+			if (insn->HasSideEffects() || insn->MayThrow()) {
+				live.insert(insn);
+				worklist.push_back(insn);
+			}
+		}
+	}
+
+	while (!worklist.empty()) {
+		const auto insn = worklist.back();
+		worklist.pop_back();
+
+		for (const auto operand : insn->m_oOperands) {
+			if (live.insert(operand).second)
+				worklist.push_back(operand);
+		}
+	}
+
+	std::vector<Instruction*> dead;
+	for (const auto& block : fn.m_oBlocks) {
+		for (const auto phi : block->m_oPhis) {
+			if (!live.contains(phi))
+				dead.push_back(phi);
+		}
+		for (const auto insn : block->m_oInstructions) {
+			if (!live.contains(insn))
+				dead.push_back(insn);
+		}
+	}
+
+	// operands first, so that dead cycles between phis don't matter
+	for (const auto insn : dead)
+		insn->DropOperands();
+	for (const auto insn : dead)
+		fn.Remove(insn);
+
+	return static_cast<bloop::BloopUInt>(dead.size());
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "utils/defs.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace bloop::ir {
+
+	struct Function;
+
+	struct Pass {
+		virtual ~Pass() = default;
+		[[nodiscard]] virtual const char* Name() const noexcept = 0;
+
+		// returns the number of changes
+		virtual bloop::BloopUInt Run(Function& fn) = 0;
+	};
+
+	// forwards copies and trivial phis to their source
+	struct CopyPropagation : Pass {
+		[[nodiscard]] const char* Name() const noexcept override { return "copy propagation"; }
+		bloop::BloopUInt Run(Function& fn) override;
+	};
+
+	// pure values are reused in every block they dominate, memory loads only within their block
+	struct CommonSubexpressionElimination : Pass {
+		[[nodiscard]] const char* Name() const noexcept override { return "common subexpression elimination"; }
+		bloop::BloopUInt Run(Function& fn) override;
+	};
+
+	// infers which values are always ints or doubles and gives their arithmetic the typed opcodes
+	struct TypeSpecialization : Pass {
+		[[nodiscard]] const char* Name() const noexcept override { return "type specialization"; }
+		bloop::BloopUInt Run(Function& fn) override;
+	};
+
+	// moves values that are the same in every iteration to the block in front of the loop
+	struct LoopInvariantCodeMotion : Pass {
+		[[nodiscard]] const char* Name() const noexcept override { return "loop invariant code motion"; }
+		bloop::BloopUInt Run(Function& fn) override;
+	};
+
+	// stores overwritten before anything could read them
+	struct DeadStoreElimination : Pass {
+		[[nodiscard]] const char* Name() const noexcept override { return "dead store elimination"; }
+		bloop::BloopUInt Run(Function& fn) override;
+	};
+
+	// array accesses with an index that is proven to be in range skip the checks
+	struct BoundsCheckElimination : Pass {
+		[[nodiscard]] const char* Name() const noexcept override { return "bounds check elimination"; }
+		bloop::BloopUInt Run(Function& fn) override;
+	};
+
+	// values that nothing observes
+	struct DeadCodeElimination : Pass {
+		[[nodiscard]] const char* Name() const noexcept override { return "dead code elimination"; }
+		bloop::BloopUInt Run(Function& fn) override;
+	};
+
+	class PassManager {
+	public:
+		void Add(std::unique_ptr<Pass>&& pass) { m_oPasses.emplace_back(std::forward<decltype(pass)>(pass)); }
+		void Run(Function& fn);
+
+		[[nodiscard]] bool Empty() const noexcept { return m_oPasses.empty(); }
+
+	private:
+		std::vector<std::unique_ptr<Pass>> m_oPasses;
+	};
+}
@@ -1,28 +1,14 @@
 #include "lexer/lexer.hpp"
 #include "lexer/exception.hpp"
+#include "lexer/scan.hpp"
+#include "lexer/tables.hpp"
 
+#include <algorithm>
 #include <cassert>
-#include <unordered_map>
-
-constexpr bool IsDigit(bloop::BloopChar c) noexcept
-{
-	return c >= '0' && c <= '9';
-}
-constexpr bool IsAlpha(bloop::BloopChar c) {
-
-#ifdef UNICODE
-	return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c > 127;
-#else
-	return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
-#endif
-}
-constexpr auto IsHex(bloop::BloopChar c) -> bool
-{
-	return (c >= '0' && c <= '9') ||
-		(c >= 'a' && c <= 'f') ||
-		(c >= 'A' && c <= 'F');
-}
+#include <iterator>
+#include <utility>
 
+using namespace bloop::lexer::tables;
 using namespace bloop::lexer;
 
 CLexer::CLexer(bloop::BloopStringView buffer)
@@ -39,11 +25,18 @@ CLexer::CLexer(bloop::BloopStringView buffer)
 	assert(m_oScriptPos != m_oScriptEnd);
 
 }
+CLexer::CLexer(bloop::BloopStringView buffer, std::size_t line)
+	: CLexer(buffer) {
+	m_oParserPosition = std::make_tuple(line, size_t(1));
+}
 CLexer::~CLexer() = default;
 
 void CLexer::Parse() {
-	while (auto&& token = ReadToken())
-		m_oTokens.emplace_back(std::forward<std::unique_ptr<bloop::CToken>&&>(token));
+	// a guess, most tokens are only a few characters long
+	m_oTokens.reserve(m_sSource.size() / 4u);
+
+	for (bloop::CToken token; ReadToken(token); token = {})
+		m_oTokens.push_back(token);
 }
 
 bool CLexer::IsToken(bloop::BloopStringView t) noexcept
@@ -56,56 +49,63 @@ bool CLexer::IsToken(bloop::BloopStringView t) noexcept
 	return punctuation == t;
 }
 
-std::unique_ptr<bloop::CToken> CLexer::ReadToken()
+bool CLexer::ReadToken(bloop::CToken& token)
 {
 	m_oLastScriptPos = m_oScriptPos;
 
-	bloop::CToken token;
-
 	if (EndOfBuffer())
-		return nullptr;
+		return false;
 
 	while (true) {
 
 		if (ReadWhiteSpace() != bloop::EStatus::success)
-			return nullptr;
+			return false;
 
 		if (IsToken(BLOOPTEXT("//"))) {
 			if (ReadSingleLineComment() != bloop::EStatus::success)
-				return nullptr;
+				return false;
 		} else if (IsToken(BLOOPTEXT("/*"))) {
 			if (ReadMultiLineComment() != bloop::EStatus::success)
-				return nullptr;
+				return false;
 		} else {
 			break;
 		}
 	}
 
 	if (ReadWhiteSpace() != bloop::EStatus::success)
-		return nullptr;
+		return false;
 
-	token.m_oSourcePosition = m_oParserPosition;
+	const auto& [line, column] = m_oParserPosition;
+	token.m_uLine = static_cast<std::uint32_t>(line);
+	token.m_uColumn = static_cast<std::uint32_t>(column);
 
 	if (IsDigit(*m_oScriptPos) || (*m_oScriptPos == '.' && IsDigit(*(std::next(m_oScriptPos))))) {
 		if (ReadNumber(token) != bloop::EStatus::success) {
-			return nullptr;
+			return false;
 		}
-	} else if (IsAlpha(*m_oScriptPos) || *m_oScriptPos == '_') {
+	} else if (Is(*m_oScriptPos, cc_name_start)) {
 		if (ReadName(token) != bloop::EStatus::success) {
-			return nullptr;
+			return false;
 		}
 	} else if (*m_oScriptPos == '\"' || *m_oScriptPos == '\'') {
 		if (ReadString(token, *m_oScriptPos) != bloop::EStatus::success) {
-			return nullptr;
+			return false;
 		}
 	} else {
-		if (auto punc = ReadPunctuation())
-			return punc;
+		if (ReadPunctuation(token))
+			return true;
 
 		throw exception::LexerError(BLOOPTEXT("a token without a definition"), m_oParserPosition);
 	}
 
-	return std::make_unique<bloop::CToken>(token);
+	return true;
+}
+
+void CLexer::MoveTo(const bloop::BloopChar* pos) noexcept
+{
+	const auto current = Current();
+	scan::Advance(m_oParserPosition, current, pos);
+	m_oScriptPos += pos - current;
 }
 
 bloop::EStatus CLexer::ReadWhiteSpace() noexcept
@@ -113,81 +113,31 @@ bloop::EStatus CLexer::ReadWhiteSpace() noexcept
 	if (EndOfBuffer())
 		return bloop::EStatus::failure;
 
-	auto& [line, column] = m_oParserPosition;
-
-	while (*m_oScriptPos <= ' ') {
-
-		if (EndOfBuffer())
-			return bloop::EStatus::failure;
+	MoveTo(scan::SkipWhiteSpace(Current(), End()));
 
-		if (*m_oScriptPos == '\n') {
-			line++;
-			column = size_t(1);
-		}
-		else {
-			if (*m_oScriptPos == '\t')
-				column += size_t(4);
-			else
-				column++;
-		}
-
-		m_oScriptPos++;
-
-		if (EndOfBuffer())
-			return bloop::EStatus::failure;
-	}
+	if (EndOfBuffer())
+		return bloop::EStatus::failure;
 
 	return bloop::EStatus::success;
 }
 bloop::EStatus CLexer::ReadSingleLineComment() noexcept
 {
-	auto& [line, column] = m_oParserPosition;
-
 	if (EndOfBuffer())
 		return bloop::EStatus::failure;
 
-	while (*m_oScriptPos != '\n') {
-
-		if (*m_oScriptPos == '\t')
-			column += size_t(4);
-		else
-			column++;
-
-		m_oScriptPos++;
-
-		if (EndOfBuffer())
-			break;
-	}
-
+	MoveTo(scan::FindNewLine(Current(), End()));
 	return bloop::EStatus::success;
 }
 bloop::EStatus CLexer::ReadMultiLineComment()
 {
-	auto& [line, column] = m_oParserPosition;
-
 	if (EndOfBuffer())
 		return bloop::EStatus::failure;
 
-	while (!IsToken(BLOOPTEXT("*/"))) {
-
-		if (*m_oScriptPos == '\n') {
-			line++;
-			column = size_t(1);
-		}
-		else {
-			if (*m_oScriptPos == '\t')
-				column += size_t(4);
-			else
-				column++;
-		}
-
-		m_oScriptPos++;
-
-		if (EndOfBuffer()) {
-			throw exception::LexerError(BLOOPTEXT("expected to find */ before EOF"));
-		}
-	}
+	const auto end = scan::FindCommentEnd(Current(), End());
+	if (end == End())
+		throw exception::LexerError(BLOOPTEXT("expected to find */ before EOF"));
 
+	MoveTo(end);
 	m_oScriptPos += 2; // */
 
 	return bloop::EStatus::success;
@@ -197,6 +147,9 @@ bloop::EStatus CLexer::ReadNumber(bloop::CToken& token)
 {
 	auto& [_, column] = m_oParserPosition;
 
+	const auto start = m_oScriptPos;
+	auto end = m_oScriptPos; // a suffix isn't a part of the text
+
 	if (*m_oScriptPos == '.') { //assumes that there is a number
 
 		//if the character after the dot is not a number, then stop
@@ -204,42 +157,46 @@ bloop::EStatus CLexer::ReadNumber(bloop::CToken& token)
 			return bloop::EStatus::failure;
 		}
 
-		token.m_sSource.push_back(*m_oScriptPos++);
+		m_oScriptPos++;
 		token.m_eTokenType = ETokenType::tt_double;
 
 		//parse the integer literal after the .
-		if (ReadInteger(token) != bloop::EStatus::success)
+		if (ReadInteger(start) != bloop::EStatus::success)
 			return bloop::EStatus::failure;
+
+		end = m_oScriptPos;
 	}
 	else if (IsDigit(*m_oScriptPos)) {
 		token.m_eTokenType = ETokenType::tt_int;
 
-		if (ReadInteger(token) != bloop::EStatus::success)
+		if (ReadInteger(start) != bloop::EStatus::success)
 			return bloop::EStatus::failure;
 
-		if (EndOfBuffer())
-			return bloop::EStatus::success;
-
-		const auto isFloat = *m_oScriptPos == '.';
+		end = m_oScriptPos;
+		const auto isFloat = !EndOfBuffer() && *m_oScriptPos == '.';
 
-		if (token.m_sSource[0] == '0' && (*m_oScriptPos == 'x' || *m_oScriptPos == 'X')) {
+		if (EndOfBuffer()) {
+			// nothing can follow
+		}
+		else if (*start == '0' && (*m_oScriptPos == 'x' || *m_oScriptPos == 'X')) {
 			m_oScriptPos++; // skip x
 			if (ReadHex(token) != bloop::EStatus::success)
 				return bloop::EStatus::failure;
 		}
 		//floating point decimal
 		else if (isFloat) {
-			token.m_sSource.push_back(*m_oScriptPos++);
+			m_oScriptPos++;
 			token.m_eTokenType = ETokenType::tt_double;
 
 			//parse the integer literal after the .
-			if (ReadInteger(token) != bloop::EStatus::success)
+			if (ReadInteger(start) != bloop::EStatus::success)
 				return bloop::EStatus::failure;
 
+			end = m_oScriptPos;
 		}
 
 		//todo -> suffixes
-		if (!isFloat) {
+		if (!isFloat && !EndOfBuffer()) {
 			switch (*m_oScriptPos) {
 			case 'u':
 			case 'U':
@@ -252,12 +209,23 @@ bloop::EStatus CLexer::ReadNumber(bloop::CToken& token)
 		}
 	}
 
+	// hex constants already got their decimal text
+	if (token.m_sSource.empty()) {
+		token.m_sSource = bloop::BloopStringView(start, end);
+
+		if (token.m_sSource.find('_') != bloop::BloopStringView::npos) {
+			bloop::BloopString digits;
+			std::ranges::copy_if(token.m_sSource, std::back_inserter(digits), [](bloop::BloopChar c) { return c != '_'; });
+			token.m_sSource = Own(std::move(digits));
+		}
+	}
+
 	assert(token.m_sSource.length());
 
-	column += token.m_sSource.length();
+	column += static_cast<std::size_t>(std::distance(start, m_oScriptPos));
 	return bloop::EStatus::success;
 }
-bloop::EStatus CLexer::ReadInteger(bloop::CToken& token)
+bloop::EStatus CLexer::ReadInteger(bloop::BloopStringView::iterator start)
 {
 	auto& [_, column] = m_oParserPosition;
 
@@ -265,17 +233,16 @@ bloop::EStatus CLexer::ReadInteger(bloop::CToken& token)
 		return bloop::EStatus::failure;
 
 	while (IsDigit(*m_oScriptPos)) {
-		token.m_sSource.push_back(*m_oScriptPos++);
+		m_oScriptPos++;
 
 		if (EndOfBuffer())
 			return bloop::EStatus::success;
 
 		if (*m_oScriptPos == BLOOPTEXT('_')) {
 			m_oScriptPos++;
-			column++;
 
 			if (EndOfBuffer() || !IsDigit(*m_oScriptPos)) {
-				column += token.m_sSource.length();
+				column += static_cast<std::size_t>(std::distance(start, m_oScriptPos));
 				throw exception::LexerError(BLOOPTEXT("digit separator cannot end here"), m_oParserPosition);
 			}
 
@@ -288,12 +255,10 @@ bloop::EStatus CLexer::ReadInteger(bloop::CToken& token)
 }
 bloop::EStatus CLexer::ReadHex(bloop::CToken& token)
 {
-	auto& [_, column] = m_oParserPosition;
-
 	if (EndOfBuffer())
 		return bloop::EStatus::failure;
 
-	bloop::BloopString hexStr;
+	const auto start = m_oScriptPos;
 
 	while (true) {
 
@@ -304,23 +269,24 @@ bloop::EStatus CLexer::ReadHex(bloop::CToken& token)
 		if (!IsHex(*m_oScriptPos))
 			break;
 
-		hexStr.push_back(*m_oScriptPos++);
+		m_oScriptPos++;
 	}
 
+	const auto hexStr = bloop::BloopString(start, m_oScriptPos);
+
 	try {
 		auto intValue = std::stoll(hexStr, nullptr, 16);
-		token.m_sSource = std::to_string(intValue);
+		token.m_sSource = Own(std::to_string(intValue));
 	}
 	catch ([[maybe_unused]] std::out_of_range& ex) {
 		try {
 			const auto uintValue = std::stoull(hexStr, nullptr, 16);
-			token.m_sSource = std::to_string(uintValue);
+			token.m_sSource = Own(std::to_string(uintValue));
 		}
 		catch ([[maybe_unused]] std::out_of_range& ex) {
 			throw exception::LexerError(BLOOPTEXT("constant value is out of range"), m_oParserPosition);
 		}
 	}
-	column += hexStr.length();
 	return bloop::EStatus::success;
 }
 
@@ -329,7 +295,11 @@ bloop::EStatus CLexer::ReadString(bloop::CToken& token, bloop::BloopChar quote)
 	auto& [line, column] = m_oParserPosition;
 
 	token.m_eTokenType = ETokenType::tt_string;
-	++m_oScriptPos;
+	const auto start = ++m_oScriptPos;
+
+	// only strings with escape sequences need a copy
+	bloop::BloopString decoded;
+	auto hasEscapes = false;
 
 	do {
 		if (EndOfBuffer())
@@ -345,10 +315,13 @@ bloop::EStatus CLexer::ReadString(bloop::CToken& token, bloop::BloopChar quote)
 			column += (*m_oScriptPos == '\t' ? 4 : 1);
 		}
 
-		if (*m_oScriptPos == BLOOPTEXT('\\'))
-			token.m_sSource.push_back(ReadEscapeCharacter());
-		else
-			token.m_sSource.push_back(*m_oScriptPos);
+		if (*m_oScriptPos == BLOOPTEXT('\\')) {
+			if (!std::exchange(hasEscapes, true))
+				decoded.assign(start, m_oScriptPos);
+			decoded.push_back(ReadEscapeCharacter());
+		} else if (hasEscapes) {
+			decoded.push_back(*m_oScriptPos);
+		}
 
 		m_oScriptPos++;
 
@@ -357,6 +330,7 @@ bloop::EStatus CLexer::ReadString(bloop::CToken& token, bloop::BloopChar quote)
 
 	} while (*m_oScriptPos != quote);
 
+	token.m_sSource = hasEscapes ? Own(std::move(decoded)) : bloop::BloopStringView(start, m_oScriptPos);
 	m_oScriptPos++;  //skip "
 	column++;
 
@@ -429,59 +403,46 @@ bloop::BloopChar CLexer::ReadHexCharacter()
 	return static_cast<bloop::BloopChar>(static_cast<unsigned char>(intValue)); //it's fine!!!!!
 }
 
-const std::unordered_map<bloop::BloopStringView, bloop::ETokenType> reservedKeywords = {
-#define BLOOP_X(name) { BLOOPTEXT(#name), bloop::ETokenType::tt_##name },
-#include "token_keywords.def"
-#undef BLOOP_X
-};
-
-bloop::EStatus CLexer::ReadName(bloop::CToken& token) noexcept
+bloop::EStatus CLexer::ReadName(bloop::CToken& token)
 {
 	auto& [_, column] = m_oParserPosition;
 
-	token.m_sSource.push_back(*m_oScriptPos++);
+	const auto start = m_oScriptPos++;
 	token.m_eTokenType = ETokenType::tt_name;
 
-	if (EndOfBuffer())
-		return bloop::EStatus::success;
-
-	while (std::isalnum(*m_oScriptPos) || *m_oScriptPos == '_') {
-		token.m_sSource.push_back(*m_oScriptPos++);
-		if (EndOfBuffer())
-			break;
-	}
+	m_oScriptPos += scan::SkipName(Current(), End()) - Current();
+	token.m_sSource = bloop::BloopStringView(start, m_oScriptPos);
 
-	if (reservedKeywords.contains(token.m_sSource)) {
-		token.m_eTokenType = reservedKeywords.at(token.m_sSource);
+	if (const auto keyword = keywordTrie.Find(token.m_sSource)) {
+		token.m_eTokenType = keywords[*keyword].m_eType;
+	} else {
+		token.m_uNameId = m_oNames.Intern(token.m_sSource);
 	}
 
 	column += token.m_sSource.length();
 	return bloop::EStatus::success;
 }
-std::unique_ptr<bloop::CToken> CLexer::ReadPunctuation() noexcept
+bool CLexer::ReadPunctuation(bloop::CToken& token) noexcept
 {
-	auto& [line, column] = m_oParserPosition;
-
-	for (const auto& i : punctuations) {
-		if (static_cast<size_t>(std::distance(m_oScriptPos, m_oScriptEnd)) >= i.m_sIdentifier.length()) {
-			const auto end = m_oScriptPos + static_cast<ptrdiff_t>(i.m_sIdentifier.length());
-			const auto punctuation = bloop::BloopStringView(m_oScriptPos, end);
-
-			if (punctuation.empty())
-				return nullptr;
-
-			if (!punctuation.compare(i.m_sIdentifier)) {
-				auto token = std::make_unique<CPunctuationToken>(i);
-				token->m_oSourcePosition = std::tie(line, column);
+	auto& [_, column] = m_oParserPosition;
 
-				column += token->m_sSource.length();
-				m_oScriptPos += static_cast<ptrdiff_t>(token->m_sSource.length());
-				return token;
-			}
-		}
+	if (!Is(*m_oScriptPos, cc_punctuation))
+		return false;
 
-	}
+	const auto match = punctuationTrie.LongestPrefix(bloop::BloopStringView(m_oScriptPos, m_oScriptEnd));
+	if (!match)
+		return false;
 
+	const auto& p = punctuations[match->m_uWord];
+	token.m_eTokenType = ETokenType::tt_operator;
+	token.m_ePunctuation = p.m_ePunctuation;
+	token.m_ePriority = p.m_ePriority;
+	token.m_sSource = bloop::BloopStringView(m_oScriptPos, m_oScriptPos + static_cast<std::ptrdiff_t>(match->m_uLength));
 
-	return nullptr;
+	column += match->m_uLength;
+	m_oScriptPos += static_cast<std::ptrdiff_t>(match->m_uLength);
+	return true;
 }
+bloop::BloopStringView CLexer::Own(bloop::BloopString&& text) {
+	return m_oOwnedText.emplace_back(std::move(text));
+}
\ No newline at end of file
@@ -1,8 +1,9 @@
 #pragma once
 
+#include "lexer/names.hpp"
 #include "lexer/token.hpp"
 
-#include <memory>
+#include <deque>
 #include <vector>
 
 namespace bloop::lexer {
@@ -12,29 +13,44 @@ namespace bloop::lexer {
 		CLexer(bloop::BloopStringView buffer);
 		~CLexer();
 
-		[[nodiscard]] void Parse();
+		void Parse();
+
+		// splits a big script at new lines and lexes the pieces on a thread pool, 0 threads means one per core
+		// the tokens are the same as what Parse produces, small scripts are lexed on this thread
+		void ParseParallel(std::size_t numThreads = 0u);
 		[[nodiscard]] auto& GetTokens() const { return m_oTokens; }
+		[[nodiscard]] auto& GetNames() const { return m_oNames; }
 
 	private:
+		// a piece of a bigger script that starts at the beginning of a line
+		CLexer(bloop::BloopStringView buffer, std::size_t line);
+
 		[[nodiscard]] constexpr bool EndOfBuffer() const noexcept { return m_oScriptPos == m_oScriptEnd; }
 		[[nodiscard]] bool IsToken(bloop::BloopStringView t) noexcept;
 
-		[[nodiscard]] std::unique_ptr<bloop::CToken> ReadToken();
+		[[nodiscard]] const bloop::BloopChar* Current() const noexcept { return m_sSource.data() + (m_oScriptPos - m_sSource.begin()); }
+		[[nodiscard]] const bloop::BloopChar* End() const noexcept { return m_sSource.data() + m_sSource.size(); }
+		void MoveTo(const bloop::BloopChar* pos) noexcept; // the line and column follow the position
+
+		[[nodiscard]] bool ReadToken(bloop::CToken& token);
 
 		[[nodiscard]] bloop::EStatus ReadWhiteSpace() noexcept;
 		[[nodiscard]] bloop::EStatus ReadSingleLineComment() noexcept;
 		[[nodiscard]] bloop::EStatus ReadMultiLineComment();
 
 		[[nodiscard]] bloop::EStatus ReadNumber(bloop::CToken& token);
-		[[nodiscard]] bloop::EStatus ReadInteger(bloop::CToken& token);
+		[[nodiscard]] bloop::EStatus ReadInteger(bloop::BloopStringView::iterator start);
 		[[nodiscard]] bloop::EStatus ReadHex(bloop::CToken& token);
 
 		[[nodiscard]] bloop::EStatus ReadString(bloop::CToken& token, bloop::BloopChar quote);
 		[[nodiscard]] bloop::BloopChar ReadEscapeCharacter();
 		[[nodiscard]] bloop::BloopChar ReadHexCharacter();
 
-		[[nodiscard]] bloop::EStatus ReadName(bloop::CToken& token) noexcept;
-		[[nodiscard]] std::unique_ptr<bloop::CToken> ReadPunctuation() noexcept;
+		[[nodiscard]] bloop::EStatus ReadName(bloop::CToken& token);
+		[[nodiscard]] bool ReadPunctuation(bloop::CToken& token) noexcept;
+
+		// for text that isn't in the script as it is, tokens point here instead
+		[[nodiscard]] bloop::BloopStringView Own(bloop::BloopString&& text);
 
 
 		bloop::BloopStringView::iterator m_oScriptPos;
@@ -44,6 +60,9 @@ namespace bloop::lexer {
 		bloop::CodePosition m_oParserPosition;
 		bloop::BloopStringView m_sSource;
 
-		std::vector<std::unique_ptr<bloop::CToken>> m_oTokens;
+		std::vector<bloop::CToken> m_oTokens;
+		CNameTable m_oNames;
+		std::deque<bloop::BloopString> m_oOwnedText; // doesn't move its strings when it grows
+		std::vector<std::deque<bloop::BloopString>> m_oPieceText; // owned text of the lexers that lexed a piece of the script
 	};
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#include "lexer/names.hpp"
+
+using namespace bloop::lexer;
+
+bloop::BloopNameId CNameTable::Intern(bloop::BloopStringView name)
+{
+	const auto [itr, added] = m_oIds.try_emplace(name, static_cast<bloop::BloopNameId>(m_oNames.size()));
+
+	if (added)
+		m_oNames.push_back(name);
+
+	return itr->second;
+}
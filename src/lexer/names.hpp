@@ -0,0 +1,23 @@
+#pragma once
+
+#include "utils/defs.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace bloop::lexer {
+
+	// gives every distinct name a small id, in the order the names first appear
+	// the names are views, so the text has to outlive the table
+	class CNameTable final {
+	public:
+		[[nodiscard]] bloop::BloopNameId Intern(bloop::BloopStringView name);
+
+		[[nodiscard]] bloop::BloopStringView GetName(bloop::BloopNameId id) const noexcept { return m_oNames[id]; }
+		[[nodiscard]] std::size_t Size() const noexcept { return m_oNames.size(); }
+
+	private:
+		std::unordered_map<bloop::BloopStringView, bloop::BloopNameId> m_oIds;
+		std::vector<bloop::BloopStringView> m_oNames;
+	};
+}
@@ -0,0 +1,152 @@
+#include "lexer/lexer.hpp"
+#include "lexer/scan.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <ranges>
+#include <thread>
+
+using namespace bloop::lexer;
+
+namespace {
+	struct Piece {
+		std::size_t m_uBegin{};
+		std::size_t m_uEnd{};
+		std::size_t m_uLine{}; // of the first character
+	};
+
+	// a piece ends after a new line that isn't in a string or a comment, so it starts at the beginning of a token
+	// tokens never contain a new line, the lexer throws at a new line within a string
+	[[nodiscard]] std::vector<Piece> Split(bloop::BloopStringView source, std::size_t numPieces) {
+
+		const auto data = source.data();
+		const auto end = data + source.size();
+		const auto pieceSize = source.size() / numPieces;
+
+		std::vector<Piece> pieces;
+		Piece current{ .m_uLine = 1u };
+		std::size_t line{ 1u };
+
+		for (auto pos = data; pos != end;) {
+			switch (*pos) {
+			case '\n': {
+				line++;
+				const auto offset = static_cast<std::size_t>(++pos - data);
+
+				// a new line at the very end would leave an empty piece after it
+				if (offset - current.m_uBegin >= pieceSize && pieces.size() + 1u < numPieces && offset < source.size()) {
+					current.m_uEnd = offset;
+					pieces.push_back(current);
+					current = { .m_uBegin = offset, .m_uLine = line };
+				}
+				continue;
+			}
+			case '\"':
+			case '\'': {
+				const auto quote = *pos++;
+				while (pos != end && *pos != quote && *pos != '\n') {
+					if (*pos == '\\' && std::next(pos) != end && pos[1] != '\n')
+						pos++;
+					pos++;
+				}
+
+				// a new line here is an error, so the piece must not end at it
+				if (pos != end && *pos == '\n')
+					line++;
+				if (pos != end)
+					pos++;
+				continue;
+			}
+			case '/':
+				if (end - pos >= 2 && pos[1] == '/') {
+					pos = scan::FindNewLine(pos, end);
+					continue;
+				}
+				if (end - pos >= 2 && pos[1] == '*') {
+					// the lexer lets the '*' of "/*" be the start of "*/" too
+					const auto close = scan::FindCommentEnd(pos + 1, end);
+					line += static_cast<std::size_t>(std::count(pos, close, '\n'));
+					pos = close == end ? end : close + 2;
+					continue;
+				}
+				break;
+			}
+			pos++;
+		}
+
+		current.m_uEnd = source.size();
+		pieces.push_back(current);
+		return pieces;
+	}
+}
+
+void CLexer::ParseParallel(std::size_t numThreads)
+{
+	if (!numThreads)
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	// a few pieces per thread, so that one slow piece doesn't leave the other threads idle
+	const auto numPieces = std::min<std::size_t>(m_sSource.size() / BLOOP_LEX_CHUNK_SIZE, numThreads * 4u);
+	if (numThreads == 1u || numPieces < 2u)
+		return Parse();
+
+	const auto pieces = Split(m_sSource, numPieces);
+
+	std::vector<std::unique_ptr<CLexer>> lexers;
+	for (const auto& piece : pieces)
+		lexers.emplace_back(new CLexer(m_sSource.substr(piece.m_uBegin, piece.m_uEnd - piece.m_uBegin), piece.m_uLine));
+
+	std::vector<std::exception_ptr> errors(pieces.size());
+	std::atomic<std::size_t> next{};
+
+	const auto work = [&]() {
+		for (auto i = next++; i < lexers.size(); i = next++) {
+			try {
+				lexers[i]->Parse();
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+	};
+
+	{
+		std::vector<std::jthread> workers;
+		for (auto i = 1u; i < std::min(numThreads, pieces.size()); i++)
+			workers.emplace_back(work);
+		work();
+	}
+
+	std::size_t numTokens{};
+	for (const auto& lexer : lexers)
+		numTokens += lexer->m_oTokens.size();
+	m_oTokens.reserve(numTokens);
+
+	// the same tokens and the same first error as when lexing the whole script at once
+	for (std::size_t i{}; i < lexers.size(); i++) {
+		auto& lexer = *lexers[i];
+
+		// the piece numbered its names on its own, new names get the next ids like they would in one pass
+		std::vector<bloop::BloopNameId> ids(lexer.m_oNames.Size());
+		for (std::size_t id{}; id < ids.size(); id++)
+			ids[id] = m_oNames.Intern(lexer.m_oNames.GetName(static_cast<bloop::BloopNameId>(id)));
+
+		const auto first = m_oTokens.insert(m_oTokens.end(), lexer.m_oTokens.begin(), lexer.m_oTokens.end());
+		for (auto& token : std::ranges::subrange(first, m_oTokens.end())) {
+			if (token.Type() == ETokenType::tt_name)
+				token.m_uNameId = ids[token.m_uNameId];
+		}
+		m_oPieceText.push_back(std::move(lexer.m_oOwnedText)); // the strings stay where the tokens point to
+
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+
+		m_oScriptPos = m_sSource.begin() + (lexer.Current() - m_sSource.data());
+		m_oParserPosition = lexer.m_oParserPosition;
+
+		// the piece ended early, so the rest of the script wouldn't have been lexed either
+		if (!lexer.EndOfBuffer())
+			break;
+	}
+}
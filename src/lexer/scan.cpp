@@ -0,0 +1,145 @@
+#include "lexer/scan.hpp"
+#include "lexer/tables.hpp"
+
+#include <bit>
+#include <cstdint>
+
+#ifdef BLOOP_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace bloop::lexer;
+
+#ifdef BLOOP_SSE2
+namespace {
+	constexpr std::ptrdiff_t chunkSize = sizeof(__m128i);
+
+	[[nodiscard]] inline __m128i Load(const bloop::BloopChar* pos) noexcept {
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+	}
+	[[nodiscard]] inline std::uint32_t Mask(__m128i bytes) noexcept {
+		return static_cast<std::uint32_t>(_mm_movemask_epi8(bytes));
+	}
+	[[nodiscard]] inline __m128i Equals(__m128i bytes, char c) noexcept {
+		return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+	}
+	// lo <= c <= hi, the comparison is signed like the scalar one
+	[[nodiscard]] inline __m128i InRange(__m128i bytes, char lo, char hi) noexcept {
+		return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8(hi + 1)));
+	}
+}
+#endif
+
+const bloop::BloopChar* scan::SkipWhiteSpace(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept
+{
+	// usually there's nothing or a single space to skip
+	if (pos == end || *pos > ' ')
+		return pos;
+
+#ifdef BLOOP_SSE2
+	for (; end - pos >= chunkSize; pos += chunkSize) {
+		if (const auto mask = Mask(_mm_cmpgt_epi8(Load(pos), _mm_set1_epi8(' '))))
+			return pos + std::countr_zero(mask);
+	}
+#endif
+
+	while (pos != end && *pos <= ' ')
+		pos++;
+
+	return pos;
+}
+const bloop::BloopChar* scan::FindNewLine(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept
+{
+#ifdef BLOOP_SSE2
+	for (; end - pos >= chunkSize; pos += chunkSize) {
+		if (const auto mask = Mask(Equals(Load(pos), '\n')))
+			return pos + std::countr_zero(mask);
+	}
+#endif
+
+	while (pos != end && *pos != '\n')
+		pos++;
+
+	return pos;
+}
+const bloop::BloopChar* scan::FindCommentEnd(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept
+{
+#ifdef BLOOP_SSE2
+	// the '/' is read from the next chunk, so it has to be in the buffer too
+	for (; end - pos > chunkSize; pos += chunkSize) {
+		const auto closes = _mm_and_si128(Equals(Load(pos), '*'), Equals(Load(pos + 1), '/'));
+		if (const auto mask = Mask(closes))
+			return pos + std::countr_zero(mask);
+	}
+#endif
+
+	for (; end - pos >= 2; pos++) {
+		if (pos[0] == '*' && pos[1] == '/')
+			return pos;
+	}
+
+	return end;
+}
+const bloop::BloopChar* scan::SkipName(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept
+{
+#ifdef BLOOP_SSE2
+	for (; end - pos >= chunkSize; pos += chunkSize) {
+		const auto bytes = Load(pos);
+		const auto lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+
+		auto name = _mm_or_si128(InRange(lower, 'a', 'z'), InRange(bytes, '0', '9'));
+		name = _mm_or_si128(name, Equals(bytes, '_'));
+
+		if (const auto mask = ~Mask(name) & 0xffffu)
+			return pos + std::countr_zero(mask);
+	}
+#endif
+
+	while (pos != end && tables::Is(*pos, tables::cc_name))
+		pos++;
+
+	return pos;
+}
+
+void scan::Advance(bloop::CodePosition& position, const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept
+{
+	auto& [line, column] = position;
+
+	// only the characters after the last new line move the column
+	std::size_t newLines{};
+	auto lineStart = pos;
+	std::size_t tabs{};
+
+#ifdef BLOOP_SSE2
+	for (; end - pos >= chunkSize; pos += chunkSize) {
+		const auto bytes = Load(pos);
+
+		if (const auto mask = Mask(Equals(bytes, '\n'))) {
+			newLines += static_cast<std::size_t>(std::popcount(mask));
+			lineStart = pos + (31 - std::countl_zero(mask)) + 1;
+			tabs = 0u;
+		}
+
+		const auto tabMask = Mask(Equals(bytes, '\t'));
+		const auto lineMask = pos >= lineStart ? 0xffffu : 0xffffu << (lineStart - pos);
+		tabs += static_cast<std::size_t>(std::popcount(tabMask & lineMask));
+	}
+#endif
+
+	for (; pos != end; pos++) {
+		if (*pos == '\n') {
+			newLines++;
+			lineStart = pos + 1;
+			tabs = 0u;
+		} else if (*pos == '\t') {
+			tabs++;
+		}
+	}
+
+	if (newLines) {
+		line += newLines;
+		column = std::size_t(1);
+	}
+
+	column += static_cast<std::size_t>(end - lineStart) + tabs * 3u;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "utils/defs.hpp"
+
+// sse2 is a part of every x64 target, so it doesn't need a flag
+#if !defined(BLOOP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define BLOOP_SSE2 1
+#endif
+
+// bulk scanning for the lexer, 16 characters at a time when sse2 is available
+// every function returns end when it runs out of text
+namespace bloop::lexer::scan {
+
+	// the first character that isn't whitespace (<= ' ')
+	[[nodiscard]] const bloop::BloopChar* SkipWhiteSpace(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept;
+
+	// the first '\n'
+	[[nodiscard]] const bloop::BloopChar* FindNewLine(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept;
+
+	// the '*' of the first "*/"
+	[[nodiscard]] const bloop::BloopChar* FindCommentEnd(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept;
+
+	// the first character that can't be a part of a name
+	[[nodiscard]] const bloop::BloopChar* SkipName(const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept;
+
+	// moves the line and column over the text, a tab is 4 columns wide
+	void Advance(bloop::CodePosition& position, const bloop::BloopChar* pos, const bloop::BloopChar* end) noexcept;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "lexer/punctuation.hpp"
+#include "lexer/token.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+
+// everything here is built by the compiler, so the lexer has no static initializers
+namespace bloop::lexer::tables {
+
+	enum ECharClass : std::uint8_t {
+		cc_digit = 1u << 0u,
+		cc_hex = 1u << 1u,
+		cc_name_start = 1u << 2u,
+		cc_name = 1u << 3u,
+		cc_punctuation = 1u << 4u, // starts some punctuation
+	};
+
+	[[nodiscard]] consteval auto MakeCharClasses() {
+		std::array<std::uint8_t, 256> classes{};
+
+		for (auto c = 0u; c < classes.size(); c++) {
+			const auto digit = c >= '0' && c <= '9';
+			const auto alpha = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+#ifdef UNICODE
+			const auto nameStart = alpha || c == '_' || c > 127u;
+#else
+			const auto nameStart = alpha || c == '_';
+#endif
+
+			if (digit)
+				classes[c] |= cc_digit;
+			if (digit || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))
+				classes[c] |= cc_hex;
+			if (nameStart)
+				classes[c] |= cc_name_start;
+			if (alpha || digit || c == '_')
+				classes[c] |= cc_name;
+		}
+
+		for (const auto& p : punctuations)
+			classes[static_cast<unsigned char>(p.m_sIdentifier.front())] |= cc_punctuation;
+
+		return classes;
+	}
+	inline constexpr auto charClasses = MakeCharClasses();
+
+	[[nodiscard]] constexpr bool Is(bloop::BloopChar c, ECharClass cls) noexcept {
+		return charClasses[static_cast<unsigned char>(c)] & cls;
+	}
+	[[nodiscard]] constexpr bool IsDigit(bloop::BloopChar c) noexcept { return Is(c, cc_digit); }
+	[[nodiscard]] constexpr bool IsHex(bloop::BloopChar c) noexcept { return Is(c, cc_hex); }
+
+	// a dfa that recognizes a fixed set of words, one table lookup per character
+	template<std::size_t NumNodes, std::size_t AlphabetSize>
+	struct CTrie {
+		static_assert(NumNodes <= std::numeric_limits<std::uint8_t>::max());
+
+		struct Match {
+			std::size_t m_uWord{}; // index to the word list
+			std::size_t m_uLength{};
+		};
+
+		// the longest word that the text starts with
+		[[nodiscard]] constexpr std::optional<Match> LongestPrefix(bloop::BloopStringView text) const noexcept {
+			std::optional<Match> match;
+			std::size_t node{};
+
+			for (std::size_t i{}; i < text.size(); i++) {
+				node = Next(node, text[i]);
+				if (!node)
+					break;
+
+				if (m_oWords[node])
+					match = Match{ .m_uWord = m_oWords[node] - 1u, .m_uLength = i + 1u };
+			}
+			return match;
+		}
+
+		// the index of the word that is exactly the text
+		[[nodiscard]] constexpr std::optional<std::size_t> Find(bloop::BloopStringView text) const noexcept {
+			std::size_t node{};
+
+			for (const auto c : text) {
+				node = Next(node, c);
+				if (!node)
+					return std::nullopt;
+			}
+			return m_oWords[node] ? std::optional<std::size_t>(m_oWords[node] - 1u) : std::nullopt;
+		}
+
+		[[nodiscard]] constexpr std::size_t Next(std::size_t node, bloop::BloopChar c) const noexcept {
+			return m_oNext[node][m_oAlphabet[static_cast<unsigned char>(c)]];
+		}
+
+		std::array<std::uint8_t, 256> m_oAlphabet{}; // 0 when no word has the character
+		std::array<std::array<std::uint8_t, AlphabetSize + 1u>, NumNodes> m_oNext{}; // 0 when there's no edge, the root is never a target
+		std::array<std::uint8_t, NumNodes> m_oWords{}; // index + 1 of the word that ends at the node
+	};
+
+	template<std::size_t N>
+	[[nodiscard]] consteval std::size_t CountNodes(const std::array<bloop::BloopStringView, N>& words) {
+		std::size_t count{ 1u };
+		for (const auto& word : words)
+			count += word.size();
+		return count;
+	}
+	template<std::size_t N>
+	[[nodiscard]] consteval std::size_t CountAlphabet(const std::array<bloop::BloopStringView, N>& words) {
+		std::array<bool, 256> seen{};
+		std::size_t count{};
+		for (const auto& word : words) {
+			for (const auto c : word) {
+				if (!std::exchange(seen[static_cast<unsigned char>(c)], true))
+					count++;
+			}
+		}
+		return count;
+	}
+
+	template<std::size_t NumNodes, std::size_t AlphabetSize, std::size_t N>
+	[[nodiscard]] consteval auto MakeTrie(const std::array<bloop::BloopStringView, N>& words) {
+		CTrie<NumNodes, AlphabetSize> trie;
+		std::size_t numSymbols{}, numNodes{ 1u };
+
+		for (const auto& word : words) {
+			for (const auto c : word) {
+				auto& symbol = trie.m_oAlphabet[static_cast<unsigned char>(c)];
+				if (!symbol)
+					symbol = static_cast<std::uint8_t>(++numSymbols);
+			}
+		}
+
+		for (std::size_t i{}; i < words.size(); i++) {
+			std::size_t node{};
+			for (const auto c : words[i]) {
+				auto& next = trie.m_oNext[node][trie.m_oAlphabet[static_cast<unsigned char>(c)]];
+				if (!next)
+					next = static_cast<std::uint8_t>(numNodes++);
+				node = next;
+			}
+			trie.m_oWords[node] = static_cast<std::uint8_t>(i + 1u);
+		}
+
+		return trie;
+	}
+
+	struct CKeyword {
+		bloop::BloopStringView m_sName;
+		bloop::ETokenType m_eType{};
+	};
+	inline constexpr std::array keywords = {
+#define BLOOP_X(name) CKeyword{ BLOOPTEXT(#name), bloop::ETokenType::tt_##name },
+#include "token_keywords.def"
+#undef BLOOP_X
+	};
+
+	template<typename T, std::size_t N, typename Projection>
+	[[nodiscard]] consteval auto Names(const std::array<T, N>& items, Projection&& name) {
+		std::array<bloop::BloopStringView, N> names{};
+		for (std::size_t i{}; i < N; i++)
+			names[i] = name(items[i]);
+		return names;
+	}
+
+	inline constexpr auto keywordNames = Names(keywords, [](const CKeyword& k) { return k.m_sName; });
+	inline constexpr auto keywordTrie = MakeTrie<CountNodes(keywordNames), CountAlphabet(keywordNames)>(keywordNames);
+
+	inline constexpr auto punctuationNames = Names(punctuations, [](const CPunctuation& p) { return p.m_sIdentifier; });
+	inline constexpr auto punctuationTrie = MakeTrie<CountNodes(punctuationNames), CountAlphabet(punctuationNames)>(punctuationNames);
+}
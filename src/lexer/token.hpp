@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <ranges>
 #include <array>
+#include <cstdint>
+#include <type_traits>
 
 #include "utils/defs.hpp"
 #include "lexer/punctuation.hpp"
@@ -55,45 +57,31 @@ namespace bloop {
 		}
 
 	}
-	class CPunctuationToken;
+	// a flat value that points into the script, the lexer stores them in one contiguous array
+	// the source has to outlive the tokens, as do the lexer's own copies of rewritten text
 	class CToken
 	{
 		friend class lexer::CLexer;
 	public:
 		constexpr CToken() = default;
-		constexpr CToken(BloopStringView token, ETokenType tt) : m_eTokenType(tt), m_sSource(token) {
-			assert(token.data() && token.size());
-			assert(m_eTokenType != ETokenType::tt_error);
-		}
-		constexpr virtual ~CToken() = default;
 
 		[[nodiscard]] constexpr auto Type() const noexcept { return m_eTokenType; }
-		[[nodiscard]] virtual bool IsOperator() const noexcept { return false; }
-		[[nodiscard]] virtual bool IsOperator([[maybe_unused]] EPunctuation p) const noexcept { return false; }
-		[[nodiscard]] constexpr auto& Source() const noexcept { return m_sSource; }
-		[[nodiscard]] constexpr auto& GetCodePosition() const noexcept { return m_oSourcePosition; }
-		[[nodiscard]] virtual constexpr CPunctuationToken* GetPunctuation() noexcept { return nullptr; }
-	private:
-		ETokenType m_eTokenType{ ETokenType::tt_error };
-		CodePosition m_oSourcePosition{ 1, 1 };
-	protected:
-		BloopString m_sSource;
-	};
+		[[nodiscard]] constexpr bool IsOperator() const noexcept { return m_eTokenType == ETokenType::tt_operator; }
+		[[nodiscard]] constexpr bool IsOperator(EPunctuation p) const noexcept { return IsOperator() && m_ePunctuation == p; }
+		[[nodiscard]] constexpr BloopStringView Source() const noexcept { return m_sSource; }
+		[[nodiscard]] constexpr CodePosition GetCodePosition() const noexcept { return { m_uLine, m_uColumn }; }
+		[[nodiscard]] constexpr BloopNameId NameId() const noexcept { return m_uNameId; } // only for names
+		[[nodiscard]] constexpr const CToken* GetPunctuation() const noexcept { return IsOperator() ? this : nullptr; }
 
-	class CPunctuationToken final : public CToken
-	{
-	public:
-		constexpr CPunctuationToken(const CPunctuation& p)
-			: CToken(p.m_sIdentifier, ETokenType::tt_operator), m_ePunctuation(p.m_ePunctuation), m_ePriority(p.m_ePriority) {
-		}
-		constexpr ~CPunctuationToken() = default;
-
-		[[nodiscard]] bool IsOperator() const noexcept override { return true; }
-		[[nodiscard]] bool IsOperator(EPunctuation p) const noexcept override { return m_ePunctuation == p; }
-
-		[[nodiscard]] constexpr CPunctuationToken* GetPunctuation() noexcept override { return this; }
-
-		EPunctuation m_ePunctuation{};
+		EPunctuation m_ePunctuation{}; // only for operators
 		EOperatorPriority m_ePriority{};
+
+	private:
+		ETokenType m_eTokenType{ ETokenType::tt_error };
+		std::uint32_t m_uLine{ 1u };
+		std::uint32_t m_uColumn{ 1u };
+		BloopNameId m_uNameId{};
+		BloopStringView m_sSource;
 	};
+	static_assert(std::is_trivially_copyable_v<CToken>);
 }
\ No newline at end of file
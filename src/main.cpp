@@ -1,35 +1,58 @@
 ﻿#include "lexer/lexer.hpp"
 #include "parser/parser.hpp"
 #include "resolver/resolver.hpp"
+#include "optimizer/optimizer.hpp"
 #include "ast/ast.hpp"
 #include "bytecode/build.hpp"
 #include "bytecode/function/bc_function.hpp"
 #include "vm/vm.hpp"
 
 #include <iostream>
+#include <optional>
 #include <thread>
 #include <chrono>
 using namespace std::chrono_literals;
 
-int main() {
+// bloop [--heap-snapshot <file>]
+// the snapshot is written after main returns, bloop_heapdiff compares two of them
+int main(int argc, char** argv) {
 
 	constexpr auto _code = 
 #include "code.def"
 	;
 
+	std::optional<bloop::BloopString> snapshotPath;
+	for (auto i = 1; i < argc; i++) {
+		if (bloop::BloopStringView(argv[i]) == BLOOPTEXT("--heap-snapshot") && i + 1 < argc) {
+			snapshotPath = argv[++i];
+			continue;
+		}
+
+		std::cout << "usage: " << argv[0] << " [--heap-snapshot <file>]\n";
+		return 1;
+	}
+
 	try {
 		auto lex = bloop::lexer::CLexer(_code);
-		lex.Parse();
+		lex.ParseParallel();
 			
 		bloop::parser::CLexParser parser(lex);
 
-		if (const auto code = parser.Parse()) {
+		if (auto code = parser.Parse()) {
 			bloop::resolver::Resolve(code.get());
+			bloop::optimizer::Optimize(code.get()).Print();
+
+			auto byteCode = bloop::bytecode::BuildByteCode(code.get());
+			code.reset(); // the vm only needs the bytecode, the whole ast goes at once
 
-			bloop::vm::VM vm(bloop::bytecode::BuildByteCode(code.get()));
+			bloop::vm::VM vm(std::move(byteCode));
 
+			vm.RecordAllocationSites(snapshotPath.has_value());
 			vm.Run("main");
 
+			if (snapshotPath)
+				vm.WriteHeapSnapshot(*snapshotPath);
+
 			//std::this_thread::sleep_for(5s); // just to see the memory usage drop
 
 			std::cout << "\n\nfinished!\n";
@@ -0,0 +1,243 @@
+#include "optimizer/optimizer.hpp"
+#include "ast/ast.hpp"
+#include "ast/function.hpp"
+#include "bytecode/build.hpp"
+#include "bytecode/defs.hpp"
+#include "bytecode/function/bc_function.hpp"
+#include "ir/passes.hpp"
+#include "vm/vm.hpp"
+#include "vm/value.hpp"
+#include "vm/heap/dvalue.hpp"
+#include "vm/exception.hpp"
+#include "utils/fmt.hpp"
+
+#include <cstring>
+#include <iostream>
+
+using namespace bloop::optimizer;
+
+OptimizerReport bloop::optimizer::Optimize(bloop::ast::Program* code, const OptimizerOptions& options) {
+	internal::Optimizer optimizer;
+	optimizer.m_oOptions = options;
+
+	if (!options.m_bEnabled)
+		return optimizer.m_oReport;
+
+	if (options.m_bBuildIR) {
+		auto passes = std::make_shared<bloop::ir::PassManager>();
+		if (options.m_bPropagateCopies)
+			passes->Add(std::make_unique<bloop::ir::CopyPropagation>());
+		if (options.m_bEliminateCommonSubexpressions)
+			passes->Add(std::make_unique<bloop::ir::CommonSubexpressionElimination>());
+		if (options.m_bSpecializeTypes)
+			passes->Add(std::make_unique<bloop::ir::TypeSpecialization>());
+		if (options.m_bHoistLoopInvariants)
+			passes->Add(std::make_unique<bloop::ir::LoopInvariantCodeMotion>());
+		if (options.m_bEliminateDeadStores)
+			passes->Add(std::make_unique<bloop::ir::DeadStoreElimination>());
+		// last before dce, nothing may move an access away from the comparisons that prove it
+		if (options.m_bEliminateBoundsChecks)
+			passes->Add(std::make_unique<bloop::ir::BoundsCheckElimination>());
+		if (options.m_bEliminateDeadCode)
+			passes->Add(std::make_unique<bloop::ir::DeadCodeElimination>());
+		optimizer.m_pPasses = std::move(passes);
+	}
+
+	if (options.m_bEvaluatePureCalls)
+		optimizer.CreateSandbox(code);
+
+	// folded expressions are new nodes
+	const bloop::ast::Arena::Scope scope(code->m_oArena);
+	code->Optimize(optimizer);
+	return optimizer.m_oReport;
+}
+
+void OptimizerReport::Print() const {
+	std::cout << bloop::fmt::format(
+		BLOOPTEXT("optimizer: folded {} expressions, evaluated {} calls, propagated {} constants, removed {} branches, {} loops and {} unreachable statements\n"),
+		m_uFoldedExpressions, m_uEvaluatedCalls, m_uPropagatedConstants, m_uRemovedBranches, m_uRemovedLoops, m_uRemovedStatements);
+}
+
+using namespace bloop::optimizer::internal;
+using VT = bloop::vm::Value::Type;
+
+// encodes the value the same way as the parser encodes constants
+[[nodiscard]] static bloop::ast::NodePtr<bloop::ast::Expression> ToLiteral(const bloop::vm::Value& v, const bloop::CodePosition& cp) {
+
+	auto literal = bloop::ast::Make<bloop::ast::LiteralExpression>(cp);
+
+	const auto Encode = [&literal](bloop::EValueType type, const void* data, std::size_t size) {
+		literal->m_eDataType = type;
+		literal->m_pConstant = bloop::BloopString(size, 0);
+		std::memcpy(literal->m_pConstant.data(), data, size);
+	};
+
+	switch (v.type) {
+	case VT::t_undefined:
+		literal->m_eDataType = bloop::EValueType::t_undefined;
+		break;
+	case VT::t_bool:
+		literal->m_eDataType = bloop::EValueType::t_boolean;
+		literal->m_pConstant = bloop::BloopString(1, v.b ? bloop::BloopChar('\x01') : bloop::BloopChar('\x00'));
+		break;
+	case VT::t_uint:
+		Encode(bloop::EValueType::t_uint, &v.u, sizeof(v.u));
+		break;
+	case VT::t_int:
+		Encode(bloop::EValueType::t_int, &v.i, sizeof(v.i));
+		break;
+	case VT::t_double:
+		Encode(bloop::EValueType::t_double, &v.d, sizeof(v.d));
+		break;
+	case VT::t_object:
+		if (!v.IsString())
+			return nullptr;
+		literal->m_eDataType = bloop::EValueType::t_string;
+		literal->m_pConstant = bloop::BloopString(v.obj->string.data, static_cast<std::size_t>(v.obj->string.len));
+		break;
+	default:
+		return nullptr;
+	}
+
+	return literal;
+}
+
+Optimizer::~Optimizer() = default;
+
+void Optimizer::OptimizeExpression(bloop::ast::NodePtr<bloop::ast::Expression>& expr) {
+	if (!expr)
+		return;
+
+	expr->Optimize(*this);
+
+	if (auto folded = expr->Fold(*this))
+		expr = std::move(folded);
+}
+
+void Optimizer::AddConstant(const bloop::ast::VariableDeclaration* decl, const bloop::ast::LiteralExpression* literal) {
+	if (m_oOptions.m_bPropagateConstants)
+		m_oConstants[decl] = literal;
+}
+
+bloop::ast::NodePtr<bloop::ast::Expression> Optimizer::FindConstant(const bloop::ast::VariableDeclaration* decl, const bloop::CodePosition& cp) {
+
+	const auto it = m_oConstants.find(decl);
+	if (it == m_oConstants.end())
+		return nullptr;
+
+	auto literal = bloop::ast::Make<bloop::ast::LiteralExpression>(cp);
+	literal->m_eDataType = it->second->m_eDataType;
+	literal->m_pConstant = it->second->m_pConstant;
+
+	m_oReport.m_uPropagatedConstants++;
+	return literal;
+}
+
+bloop::ast::NodePtr<bloop::ast::Expression> Optimizer::FoldBinary(bloop::EPunctuation punc,
+	const bloop::ast::LiteralExpression& left, const bloop::ast::LiteralExpression& right, const bloop::CodePosition& cp) {
+
+	if (!m_oOptions.m_bFoldConstants)
+		return nullptr;
+
+	const auto leftIsString = left.m_eDataType == bloop::EValueType::t_string;
+	const auto rightIsString = right.m_eDataType == bloop::EValueType::t_string;
+
+	if (leftIsString || rightIsString) {
+		if (!leftIsString || !rightIsString || punc != bloop::EPunctuation::p_add)
+			return nullptr; // let the vm report the error
+
+		auto literal = bloop::ast::Make<bloop::ast::LiteralExpression>(cp);
+		literal->m_eDataType = bloop::EValueType::t_string;
+		literal->m_pConstant = left.m_pConstant + right.m_pConstant;
+		m_oReport.m_uFoldedExpressions++;
+		return literal;
+	}
+
+	bloop::vm::Value a(left.m_eDataType, left.m_pConstant);
+	bloop::vm::Value b(right.m_eDataType, right.m_pConstant);
+	bloop::vm::Value result;
+
+	try {
+		switch (punc) {
+		case bloop::EPunctuation::p_add:
+			result = a + b;
+			break;
+		case bloop::EPunctuation::p_sub:
+			result = a - b;
+			break;
+		case bloop::EPunctuation::p_multiplication:
+			result = a * b;
+			break;
+		case bloop::EPunctuation::p_division:
+			result = a / b;
+			break;
+		case bloop::EPunctuation::p_less_equal:
+			result = a <= b;
+			break;
+		default:
+			return nullptr;
+		}
+	} catch ([[maybe_unused]] bloop::exception::VMError& ex) {
+		return nullptr; // e.g. division by 0, which has to happen at runtime
+	}
+
+	auto literal = ToLiteral(result, cp);
+	if (literal)
+		m_oReport.m_uFoldedExpressions++;
+
+	return literal;
+}
+
+std::optional<bool> Optimizer::IsTruthy(const bloop::ast::Expression* expr) const {
+
+	const auto literal = bloop::ast::As<bloop::ast::LiteralExpression>(expr);
+
+	if (!literal || literal->m_eDataType == bloop::EValueType::t_string)
+		return std::nullopt;
+
+	return bloop::vm::Value(literal->m_eDataType, literal->m_pConstant).IsTruthy();
+}
+
+void Optimizer::CreateSandbox(bloop::ast::Program* code) {
+
+	std::vector<bloop::bytecode::vmdata::Function> functions(code->m_uNumFunctions);
+	auto hasPureFunctions = false;
+
+	// pure functions only call each other, so the rest can stay empty
+	for (const auto& statement : code->m_oStatements) {
+		const auto func = bloop::ast::As<bloop::ast::FunctionDeclarationStatement>(statement.get());
+		if (!func || !func->m_bPure)
+			continue;
+
+		bloop::bytecode::CByteCodeFunction(func).Generate(functions, false);
+		hasPureFunctions = true;
+	}
+
+	if (!hasPureFunctions)
+		return;
+
+	bloop::bytecode::VMByteCode byteCode{ .chunk = {}, .numGlobals = 0u, .functions = std::move(functions), .constants = {} };
+	bloop::bytecode::ShareConstants(byteCode);
+	m_pSandbox = std::make_unique<bloop::vm::VM>(byteCode);
+}
+
+bloop::ast::NodePtr<bloop::ast::Expression> Optimizer::EvaluateCall(const bloop::ast::FunctionDeclarationStatement* callee,
+	const std::vector<const bloop::ast::LiteralExpression*>& args, const bloop::CodePosition& cp) {
+
+	if (!m_pSandbox)
+		return nullptr;
+
+	std::vector<bloop::bytecode::CConstant> constants;
+	for (const auto arg : args)
+		constants.push_back({ .m_pConstant = arg->m_pConstant, .m_eDataType = arg->m_eDataType });
+
+	try {
+		// arrays and functions can't be literals, those calls stay
+		auto literal = ToLiteral(m_pSandbox->Call(callee->m_uFunctionId, constants, m_oOptions.m_uEvaluationFuel), cp);
+		if (literal)
+			m_oReport.m_uEvaluatedCalls++;
+		return literal;
+	} catch ([[maybe_unused]] bloop::exception::VMError& ex) {
+		return nullptr; // fails the same way at runtime, or simply takes too long
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "utils/defs.hpp"
+#include "lexer/punctuation.hpp"
+#include "ast/arena.hpp"
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace bloop::ast {
+	struct Program;
+	struct Expression;
+	struct LiteralExpression;
+	struct VariableDeclaration;
+	struct FunctionDeclarationStatement;
+}
+namespace bloop::vm {
+	class VM;
+}
+namespace bloop::ir {
+	class PassManager;
+}
+
+namespace bloop::optimizer {
+
+	struct OptimizerOptions {
+		bool m_bEnabled{ true };
+		bool m_bFoldConstants{ true };
+		bool m_bPropagateConstants{ true };
+		bool m_bEliminateDeadCode{ true };
+
+		// function bodies go through the ssa ir (see ir/ir.hpp)
+		bool m_bBuildIR{ true };
+		bool m_bPropagateCopies{ true };
+		bool m_bEliminateCommonSubexpressions{ true };
+		bool m_bHoistLoopInvariants{ true };
+		bool m_bSpecializeTypes{ true }; // arithmetic on values with a known type
+
+		// calls to small global functions are replaced with the callee's body
+		bool m_bInlineFunctions{ true };
+		bloop::BloopUInt m_uInlineThreshold{ 16u }; // instructions in the callee
+		bool m_bEliminateDeadStores{ true };
+		bool m_bEliminateBoundsChecks{ true }; // needs m_bSpecializeTypes
+
+		// calls to pure functions with constant arguments are run at compile time
+		bool m_bEvaluatePureCalls{ true };
+		bloop::BloopUInt m_uEvaluationFuel{ 100000u }; // calls and loop iterations per evaluated call
+	};
+
+	struct OptimizerReport {
+		bloop::BloopUInt m_uFoldedExpressions{};
+		bloop::BloopUInt m_uEvaluatedCalls{};
+		bloop::BloopUInt m_uPropagatedConstants{};
+		bloop::BloopUInt m_uRemovedBranches{};
+		bloop::BloopUInt m_uRemovedLoops{};
+		bloop::BloopUInt m_uRemovedStatements{}; // unreachable code after return/break/continue
+
+		void Print() const;
+	};
+
+	// runs between the resolver and the bytecode generation, so every identifier is already resolved
+	OptimizerReport Optimize(bloop::ast::Program* code, const OptimizerOptions& options = {});
+
+	namespace internal {
+		struct Optimizer {
+			OptimizerOptions m_oOptions;
+			OptimizerReport m_oReport;
+			std::shared_ptr<bloop::ir::PassManager> m_pPasses; // null when the ir isn't used
+
+			~Optimizer();
+
+			// replaces the expression when it can be evaluated at compile time
+			void OptimizeExpression(bloop::ast::NodePtr<bloop::ast::Expression>& expr);
+
+			// the declaration is the key, because symbols don't outlive the resolver
+			void AddConstant(const bloop::ast::VariableDeclaration* decl, const bloop::ast::LiteralExpression* literal);
+			[[nodiscard]] bloop::ast::NodePtr<bloop::ast::Expression> FindConstant(const bloop::ast::VariableDeclaration* decl, const bloop::CodePosition& cp);
+
+			[[nodiscard]] bloop::ast::NodePtr<bloop::ast::Expression> FoldBinary(bloop::EPunctuation punc,
+				const bloop::ast::LiteralExpression& left, const bloop::ast::LiteralExpression& right, const bloop::CodePosition& cp);
+
+			// nullopt if the value isn't known at compile time
+			[[nodiscard]] std::optional<bool> IsTruthy(const bloop::ast::Expression* expr) const;
+
+			// compiles the pure functions before any of them gets optimized
+			void CreateSandbox(bloop::ast::Program* code);
+
+			// nullptr when the call has to happen at runtime, errors are reported by the vm then
+			[[nodiscard]] bloop::ast::NodePtr<bloop::ast::Expression> EvaluateCall(const bloop::ast::FunctionDeclarationStatement* callee,
+				const std::vector<const bloop::ast::LiteralExpression*>& args, const bloop::CodePosition& cp);
+
+		private:
+			std::unordered_map<const bloop::ast::VariableDeclaration*, const bloop::ast::LiteralExpression*> m_oConstants;
+			std::unique_ptr<bloop::vm::VM> m_pSandbox; // null when there's nothing to evaluate
+		};
+	}
+}
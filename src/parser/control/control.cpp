@@ -37,7 +37,7 @@ UniqueExpression CParserStatement::ParseExpression() {
 
 	return expr.ToExpression();
 }
-std::unique_ptr<bloop::ast::BlockStatement> CParserStatement::ParseScope() {
+bloop::ast::NodePtr<bloop::ast::BlockStatement> CParserStatement::ParseScope() {
 
 	if (IsEndOfBuffer())
 		throw exception::ParserError(BLOOPTEXT("expected a \"{\" or a statement"), GetIteratorSafe()->GetCodePosition());
@@ -25,7 +25,7 @@ namespace bloop::parser {
 	protected:
 		void ParseIdentifier(bloop::ETokenType tt);
 		[[nodiscard]] virtual UniqueExpression ParseExpression();
-		[[nodiscard]] virtual std::unique_ptr<bloop::ast::BlockStatement> ParseScope();
+		[[nodiscard]] virtual bloop::ast::NodePtr<bloop::ast::BlockStatement> ParseScope();
 
 		const CParserContext& m_oCtx;
 		bloop::CodePosition m_oDeclPos;
@@ -37,9 +37,9 @@ bloop::EStatus CParserControlStatement::Parse() {
 UniqueStatement CParserControlStatement::ToStatement() {
 	switch (type) {
 	case Type::cf_continue:
-		return std::make_unique<bloop::ast::ContinueStatement>(m_oDeclPos);
+		return bloop::ast::Make<bloop::ast::ContinueStatement>(m_oDeclPos);
 	case Type::cf_break:
-		return std::make_unique<bloop::ast::BreakStatement>(m_oDeclPos);
+		return bloop::ast::Make<bloop::ast::BreakStatement>(m_oDeclPos);
 	default:
 		throw exception::ParserError(BLOOPTEXT("type == Type::cf_error -> how?"), m_oDeclPos);
 	}
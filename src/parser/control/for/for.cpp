@@ -22,7 +22,7 @@ bloop::EStatus CParserForStatement::Parse() {
 
 	Advance(1); // skip (
 
-	m_pBody = std::make_unique<bloop::ast::BlockStatement>(GetIteratorSafe()->GetCodePosition());
+	m_pBody = bloop::ast::Make<bloop::ast::BlockStatement>(GetIteratorSafe()->GetCodePosition());
 	auto oldBlock = m_oCtx.m_pCurrentBlock;
 	m_oCtx.m_pCurrentBlock = m_pBody.get();
 
@@ -112,7 +112,7 @@ bloop::EStatus CParserForStatement::ParseEndExpression() {
 }
 UniqueStatement CParserForStatement::ToStatement() {
 
-	auto&& ptr = std::make_unique<bloop::ast::ForStatement>(m_oDeclPos);
+	auto&& ptr = bloop::ast::Make<bloop::ast::ForStatement>(m_oDeclPos);
 	ptr->m_pInitializer = std::move(m_pInitializer);
 	ptr->m_pCondition = std::move(m_pCondition);
 	ptr->m_pOnEnd = std::move(m_pOnEnd);
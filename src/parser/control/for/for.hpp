@@ -32,6 +32,6 @@ namespace bloop::parser {
 		UniqueStatement m_pInitializer;
 		UniqueExpression m_pCondition;
 		UniqueExpression m_pOnEnd;
-		std::unique_ptr<bloop::ast::BlockStatement> m_pBody;
+		bloop::ast::NodePtr<bloop::ast::BlockStatement> m_pBody;
 	};
 }
\ No newline at end of file
@@ -17,15 +17,15 @@ bloop::EStatus CParserIfStatement::Parse() {
 	auto&& scope = ParseScope();
 	m_oIf.emplace_back(std::make_unique<Structure>(Structure{ std::move(expr), std::move(scope) }));
 
-	while(CanPeek(1) && (*Peek(1))->Type() == bloop::ETokenType::tt_else) { 
+	while(CanPeek(1) && Peek(1)->Type() == bloop::ETokenType::tt_else) { 
 		
 		Advance(1); //skip }
 
 		if (m_pElse)
-			throw exception::ParserError(BLOOPTEXT("the else block was already declared"), (*Peek(1))->GetCodePosition());
+			throw exception::ParserError(BLOOPTEXT("the else block was already declared"), Peek(1)->GetCodePosition());
 
 		//else if
-		if (CanPeek(1) && (*Peek(1))->Type() == bloop::ETokenType::tt_if) {
+		if (CanPeek(1) && Peek(1)->Type() == bloop::ETokenType::tt_if) {
 			Advance(1); // skip else
 			ParseIdentifier(bloop::ETokenType::tt_if);
 
@@ -44,7 +44,7 @@ bloop::EStatus CParserIfStatement::Parse() {
 }
 UniqueStatement CParserIfStatement::ToStatement() {
 
-	auto&& ptr = std::make_unique<bloop::ast::IfStatement>(m_oDeclPos);
+	auto&& ptr = bloop::ast::Make<bloop::ast::IfStatement>(m_oDeclPos);
 
 	ptr->m_oIf = std::move(m_oIf);
 	ptr->m_pElse = std::move(m_pElse);
@@ -27,7 +27,7 @@ namespace bloop::parser {
 
 	private:
 		std::vector<std::unique_ptr<Structure>> m_oIf;
-		std::unique_ptr<bloop::ast::BlockStatement> m_pElse;
+		bloop::ast::NodePtr<bloop::ast::BlockStatement> m_pElse;
 
 	};
 }
\ No newline at end of file
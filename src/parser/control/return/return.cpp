@@ -29,5 +29,5 @@ UniqueExpression CParserReturnStatement::ParseExpression() {
 	return expr.ToExpression();
 }
 UniqueStatement CParserReturnStatement::ToStatement() {
-	return std::make_unique<bloop::ast::ReturnStatement>(std::move(m_pExpression), m_oDeclPos);
+	return bloop::ast::Make<bloop::ast::ReturnStatement>(std::move(m_pExpression), m_oDeclPos);
 }
\ No newline at end of file
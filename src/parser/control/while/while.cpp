@@ -16,7 +16,7 @@ bloop::EStatus CParserWhileStatement::Parse() {
 }
 UniqueStatement CParserWhileStatement::ToStatement() {
 
-	auto&& whileStatement = std::make_unique<bloop::ast::WhileStatement>(m_oDeclPos);
+	auto&& whileStatement = bloop::ast::Make<bloop::ast::WhileStatement>(m_oDeclPos);
 	whileStatement->m_pCondition = std::move(m_pCondition);
 
 	auto wtf = static_cast<bloop::ast::BlockStatement*>(m_pBody.get());
@@ -64,10 +64,11 @@ bloop::EStatus CParserDeclaration::ParseInitializer() {
 
 }
 UniqueStatement CParserDeclaration::ToStatement() {
+	// no initializer with "let var;"
 	if (m_bIsConst)
-		return std::make_unique<bloop::ast::ConstVariableDeclaration>(m_pIdentifier->Source(), ToExpression(), m_pIdentifier->GetCodePosition());
+		return bloop::ast::Make<bloop::ast::ConstVariableDeclaration>(bloop::BloopString(m_pIdentifier->Source()), m_pIdentifier->NameId(), std::move(m_pExpression), m_pIdentifier->GetCodePosition());
 
-	return std::make_unique<bloop::ast::VariableDeclaration>(m_pIdentifier->Source(), ToExpression(), m_pIdentifier->GetCodePosition());
+	return bloop::ast::Make<bloop::ast::VariableDeclaration>(bloop::BloopString(m_pIdentifier->Source()), m_pIdentifier->NameId(), std::move(m_pExpression), m_pIdentifier->GetCodePosition());
 }
 UniqueExpression CParserDeclaration::ToExpression() {
 	assert(m_pExpression);
@@ -34,7 +34,7 @@ namespace bloop::parser {
 		const CParserContext& m_oCtx;
 		bool m_bIsConst{};
 		const bloop::CToken* m_pIdentifier{};
-		std::unique_ptr<bloop::ast::Expression> m_pExpression;
+		bloop::ast::NodePtr<bloop::ast::Expression> m_pExpression;
 	};
 
 	[[nodiscard]] bool IsDeclaration(const bloop::CToken* token) noexcept;
@@ -1,10 +1,11 @@
 #pragma once
 
+#include "ast/arena.hpp"
+
 #include <vector>
 #include <memory>
 
 namespace bloop {
-	class CPunctuationToken;
 	class CToken;
 }
 namespace bloop::ast {
@@ -14,8 +15,8 @@ namespace bloop::ast {
 
 namespace bloop::parser {
 
-	using UniqueStatement = std::unique_ptr<bloop::ast::Statement>;
-	using UniqueExpression = std::unique_ptr<bloop::ast::Expression>;
+	using UniqueStatement = bloop::ast::NodePtr<bloop::ast::Statement>;
+	using UniqueExpression = bloop::ast::NodePtr<bloop::ast::Expression>;
 
 	struct IStatement {
 		virtual ~IStatement() = default;
@@ -23,7 +24,8 @@ namespace bloop::parser {
 		[[nodiscard]] virtual UniqueStatement ToStatement() = 0;
 	};
 
-	using ParserIterator = std::vector<bloop::CToken*>::iterator;
+	// points into the lexer's flat token array
+	using ParserIterator = const bloop::CToken*;
 
 	class CParser {
 	public:
@@ -32,8 +34,7 @@ namespace bloop::parser {
 		virtual ~CParser() = default;
 
 		[[nodiscard]] constexpr bool IsEndOfBuffer() const noexcept { return m_iterPos == m_iterEnd; }
-		[[nodiscard]] constexpr auto GetIteratorSafe() { return IsEndOfBuffer() ? *std::prev(m_iterPos) : *m_iterPos; }
-		[[nodiscard]] constexpr auto GetIteratorSafe() const { return IsEndOfBuffer() ? *std::prev(m_iterPos) : *m_iterPos; }
+		[[nodiscard]] constexpr auto GetIteratorSafe() const { return IsEndOfBuffer() ? std::prev(m_iterPos) : m_iterPos; }
 
 		constexpr void Advance(std::ptrdiff_t amount) const noexcept { std::advance(m_iterPos, amount); }
 		[[nodiscard]] constexpr bool CanPeek(std::ptrdiff_t amount) const noexcept { return std::next(m_iterPos, amount) != m_iterEnd; }
@@ -2,44 +2,25 @@
 #include "parser/parser.hpp"
 #include "ast/ast.hpp"
 #include "parser/exception.hpp"
-#include "parser/expression/sub_expression.hpp"
 #include "parser/operand/operand.hpp"
 #include "lexer/punctuation.hpp"
-#include "parser/expression/operator.hpp"
 
 #include <cassert>
 
 using namespace bloop::parser;
 
 [[nodiscard]] static auto MakeBinary(bloop::EPunctuation punct, bloop::CodePosition pos) {
-	return std::make_unique<bloop::ast::BinaryExpression>(punct, pos);
+	return bloop::ast::Make<bloop::ast::BinaryExpression>(punct, pos);
 }
-
-CExpressionChain::CExpressionChain() = default;
-CExpressionChain::~CExpressionChain() = default;
-
-std::vector<UniqueExpression> CExpressionChain::ToList() {
-	
-	std::vector<UniqueExpression> list;
-
-	auto pos = this;
-	while (pos) {
-		list.emplace_back(std::move(pos->m_pExpression));
-		pos = pos->m_pNext.get();
-	}
-	return list;
+[[nodiscard]] static constexpr bool IsBinaryOperator(const bloop::CToken* token) noexcept {
+	return token->IsOperator() && token->m_ePriority >= bloop::EOperatorPriority::op_assignment
+		&& token->m_ePriority <= bloop::EOperatorPriority::op_multiplicative;
 }
-UniqueExpression CExpressionChain::ToMerged()
-{
-	if (!m_pNext)
-		return std::move(m_pExpression);
-
-	auto root = MakeBinary(bloop::EPunctuation::p_comma, m_pExpression->m_oApproximatePosition);
-	root->left = std::move(m_pExpression);
-	root->right = m_pNext->ToMerged();
-	return root;
+[[nodiscard]] static constexpr bloop::EOperatorPriority NextPriority(bloop::EOperatorPriority priority) noexcept {
+	return static_cast<bloop::EOperatorPriority>(static_cast<char>(priority) + 1);
 }
-CParserExpression::CParserExpression(const CParserContext& ctx) 
+
+CParserExpression::CParserExpression(const CParserContext& ctx)
 	: CParserSingle(ctx.m_iterPos, ctx.m_iterEnd), m_oCtx(ctx) {
 	assert(!IsEndOfBuffer());
 	m_oDeclPos = GetIteratorSafe()->GetCodePosition();
@@ -49,161 +30,122 @@ CParserExpression::~CParserExpression() = default;
 CParserExpressionStatement::CParserExpressionStatement(const CParserContext& ctx) : CParserExpression(ctx){}
 CParserExpressionStatement::~CParserExpressionStatement() = default;
 
-bloop::EStatus CParserExpression::Parse(std::optional<PairMatcher> eoe, CExpressionChain* expression, EEvaluationType evalType) {
-	return ParseInternal(eoe, expression, evalType);
-}
+bloop::EStatus CParserExpression::Parse(std::optional<PairMatcher> eoe) {
 
-bloop::EStatus CParserExpression::ParseInternal(std::optional<PairMatcher>& eoe, CExpressionChain* expression, EEvaluationType evalType) {
+	m_oEndOfExpression = eoe;
 
-	if (EndOfExpression(eoe))
+	if (EndOfExpression())
 		throw exception::ParserError(BLOOPTEXT("expected an expression"), GetIteratorSafe()->GetCodePosition());
 
-	if (!expression) {
-		m_pEvaluatedExpressions = std::make_unique<CExpressionChain>();
-	}
-
-	auto actualExpression = expression ? expression : m_pEvaluatedExpressions.get();
-	auto status = EStatus::failure;
-
-	do {
-		//the previous token was an operator, so we need an operand
-		if (EndOfExpression(eoe) && !m_oSubExpressions.empty())
-			throw exception::ParserError(BLOOPTEXT("expected an operand, but found ") + GetIteratorSafe()->Source(), GetIteratorSafe()->GetCodePosition());
-
-		auto subExpr = std::make_unique<CParserSubExpression>(m_oCtx);
-		status = subExpr->Parse(eoe, actualExpression, evalType);
-		m_oSubExpressions.emplace_back(std::move(subExpr));
+	while (true) {
+		m_oExpressions.emplace_back(ParseBinary(EOperatorPriority::op_assignment, IsStatement() && m_oExpressions.empty()));
 
-	} while (status == EStatus::success);
+		if (EndOfExpression())
+			break;
 
-	assert(!m_oSubExpressions.empty());
+		Advance(1); // skip ,
 
-	if (evalType == EEvaluationType::evaluate_everything && eoe && EndOfExpression(eoe)) {
-		Advance(1);
-		eoe = std::nullopt;
+		if (IsEndOfBuffer() || EndOfExpression())
+			throw exception::ParserError(BLOOPTEXT("expected an expression"), GetIteratorSafe()->GetCodePosition());
 	}
 
-	actualExpression->m_pExpression = ToExpression_Internal();
-	return EStatus::success;
+	if (m_oEndOfExpression)
+		Advance(1); // skip the closing punctuation
 
+	return EStatus::success;
 }
 
-UniqueStatement CParserExpressionStatement::ToStatement() {
-	return std::make_unique<bloop::ast::ExpressionStatement>(ToExpression(), m_oDeclPos);
-}
-UniqueExpression CParserExpression::ToExpression_Internal() {
+UniqueExpression CParserExpression::ParseBinary(EOperatorPriority minPriority, bool isRoot) {
 
-	Operands operands;
-	Operators operators;
+	auto lhs = ParseOperand();
 
-	for (const auto& subExpr : m_oSubExpressions) {
-		operands.emplace_back(&*subExpr->m_oLhsOperand);
-		if (subExpr->m_oOperator)
-			operators.emplace_back(&*subExpr->m_oOperator);
-	}
+	while (const auto op = NextOperator()) {
 
-	assert(operands.size() == operators.size() + 1u);
-	return CreateExpression(operands, operators);
-}
-UniqueExpression CParserExpression::ToExpression() {
-	return m_pEvaluatedExpressions->ToMerged();
-}
-std::vector<UniqueExpression> CParserExpression::ToList() {
-	assert(m_pEvaluatedExpressions);
-	return m_pEvaluatedExpressions->ToList();
-}
-bool CParserExpression::EndOfExpression(const std::optional<PairMatcher>& eoe) const noexcept {
-	assert(!IsEndOfBuffer());
+		if (op->m_ePriority < minPriority)
+			break;
 
-	if (!eoe)
-		return (*m_iterPos)->IsOperator(EPunctuation::p_semicolon);
+		Advance(1); // skip the operator
 
-	if (!(*m_iterPos)->IsOperator())
-		return false;
+		//the previous token was an operator, so we need an operand
+		if (IsEndOfBuffer() || EndOfExpression())
+			throw exception::ParserError(BLOOPTEXT("expected an operand, but found ") + bloop::BloopString(GetIteratorSafe()->Source()), GetIteratorSafe()->GetCodePosition());
 
-	return eoe->IsClosing(dynamic_cast<const CPunctuationToken*>(*m_iterPos)->m_ePunctuation);
-}
+		// an operator of the same priority on the right belongs to this one only when it's an assignment
+		const auto rhsPriority = op->m_ePriority == EOperatorPriority::op_assignment ? op->m_ePriority : NextPriority(op->m_ePriority);
 
-/* EXPRESSION GENERATION */
-std::unique_ptr<bloop::ast::AssignExpression> CParserExpression::MakeAssignment(bloop::CodePosition pos) {
-	if (IsStatement()) {
-		dynamic_cast<CParserExpressionStatement*>(this)->MakeNotStatement();
-		return std::make_unique<bloop::ast::AssignStatement>(pos);
+		auto node = MakeOperator(op, isRoot);
+		node->right = ParseBinary(rhsPriority, false);
+		node->left = std::move(lhs);
+		lhs = std::move(node);
 	}
-	return std::make_unique<bloop::ast::AssignExpression>(pos);
-}
-void CParserExpression::SetBranch(UniqueExpression& getter, const bloop::CPunctuationToken* t) {
-	if (t->m_ePunctuation == bloop::EPunctuation::p_assign)
-		getter = MakeAssignment(t->GetCodePosition());
-	else
-		getter = MakeBinary(t->m_ePunctuation, t->GetCodePosition());
+
+	return lhs;
 }
+UniqueExpression CParserExpression::ParseOperand() {
 
+	CParserOperand operand(m_oCtx);
 
-UniqueExpression CParserExpression::CreateExpression(Operands& operands, Operators& operators) {
+	if (operand.Parse(m_oEndOfExpression) != EStatus::success)
+		throw exception::ParserError(BLOOPTEXT("failed to parse the expression"), GetIteratorSafe()->GetCodePosition());
 
+	return operand.ToExpression();
+}
+const bloop::CToken* CParserExpression::NextOperator() const {
 
-	if (auto&& leaf = GetLeaf(operands))
-		return leaf;
+	if (IsEndOfBuffer())
+		throw exception::ParserError(BLOOPTEXT("unexpected end of buffer"), GetIteratorSafe()->GetCodePosition());
 
-	assert(!operators.empty());
+	if (EndOfExpression() || m_iterPos->IsOperator(EPunctuation::p_comma))
+		return nullptr;
 
-	UniqueExpression oper;
-	SetBranch(oper, (*FindLowestPriorityOperator(operators))->m_pToken);
-	CreateExpressionRecursively(dynamic_cast<bloop::ast::BinaryExpression*>(oper.get()), operands, operators);
-	return oper;
-}
-UniqueExpression CParserExpression::GetLeaf(Operands& operands) {
-	if (operands.size() == 1)
-		return operands.front()->ToExpression();
-	return nullptr;
-}
-CParserExpression::Operators::iterator CParserExpression::FindLowestPriorityOperator(Operators& operators) {
-
-	assert(!operators.empty());
-	
-	return std::min_element(operators.begin(), operators.end(),
-		[](auto a, auto b) {
-			return a->m_pToken->m_ePriority < b->m_pToken->m_ePriority;
-		}
-	);
+	if (!IsBinaryOperator(m_iterPos))
+		throw exception::ParserError(BLOOPTEXT("unexpected end of expression: ") + bloop::BloopString(m_iterPos->Source()), m_iterPos->GetCodePosition());
+
+	return m_iterPos;
 }
 
-void CParserExpression::CreateExpressionRecursively(bloop::ast::BinaryExpression* _this, Operands& operands, Operators& operators) {
-	if (operands.empty()) {
-		assert(operators.empty());
-		return;
+UniqueStatement CParserExpressionStatement::ToStatement() {
+	return bloop::ast::Make<bloop::ast::ExpressionStatement>(ToExpression(), m_oDeclPos);
+}
+UniqueExpression CParserExpression::ToExpression() {
+	assert(!m_oExpressions.empty());
+
+	// a, (b, c)
+	auto merged = std::move(m_oExpressions.back());
+	for (auto i = m_oExpressions.size() - 1u; i-- > 0u; ) {
+		auto comma = MakeBinary(bloop::EPunctuation::p_comma, m_oExpressions[i]->m_oApproximatePosition);
+		comma->left = std::move(m_oExpressions[i]);
+		comma->right = std::move(merged);
+		merged = std::move(comma);
 	}
 
-	assert(!operands.empty() && !operators.empty());
+	m_oExpressions.clear();
+	return merged;
+}
+std::vector<UniqueExpression> CParserExpression::ToList() {
+	return std::move(m_oExpressions);
+}
+bool CParserExpression::EndOfExpression() const noexcept {
 
-	const auto itr1 = FindLowestPriorityOperator(operators);
+	if (IsEndOfBuffer())
+		return false; // let it fail
 
-	const Operators::iterator opLhs = itr1;
-	const Operators::iterator opRhs = std::next(opLhs);
+	if (!m_oEndOfExpression)
+		return m_iterPos->IsOperator(EPunctuation::p_semicolon);
 
-	const auto operandLhs = operands.begin() + std::distance(operators.begin(), itr1) + 1;
-	const auto operandRhs = operands.begin() + std::distance(operators.begin(), itr1) + 1;
+	if (!m_iterPos->IsOperator())
+		return false;
 
-	auto lhsOperands = Operands(operands.begin(), operandLhs);
-	auto rhsOperands = Operands(operandRhs, operands.end());
+	return m_oEndOfExpression->IsClosing(m_iterPos->m_ePunctuation);
+}
 
-	auto lhsOperators = Operators(operators.begin(), opLhs);
-	auto rhsOperators = Operators(opRhs, operators.end());
+bloop::ast::NodePtr<bloop::ast::BinaryExpression> CParserExpression::MakeOperator(const bloop::CToken* op, bool isRoot) const {
 
-	if (!lhsOperands.empty()) {
-		if (_this->left = GetLeaf(lhsOperands), !_this->left) {
-			const auto l = FindLowestPriorityOperator(lhsOperators);
-			SetBranch(_this->left, (*l)->m_pToken);
-			CreateExpressionRecursively(dynamic_cast<bloop::ast::BinaryExpression*>(_this->left.get()), lhsOperands, lhsOperators);
-		}
-	} if (!rhsOperands.empty()) {
-		if (_this->right = GetLeaf(rhsOperands), !_this->right) {
-			const auto l = FindLowestPriorityOperator(rhsOperators);
-			SetBranch(_this->right, (*l)->m_pToken);
-			CreateExpressionRecursively(dynamic_cast<bloop::ast::BinaryExpression*>(_this->right.get()), rhsOperands, rhsOperators);
-		}
-	}
+	if (op->m_ePunctuation != bloop::EPunctuation::p_assign)
+		return MakeBinary(op->m_ePunctuation, op->GetCodePosition());
 
+	if (isRoot)
+		return bloop::ast::Make<bloop::ast::AssignStatement>(op->GetCodePosition());
 
+	return bloop::ast::Make<bloop::ast::AssignExpression>(op->GetCodePosition());
 }
@@ -9,74 +9,47 @@
 
 namespace bloop::ast {
 	struct BinaryExpression;
-	struct AssignExpression;
 }
 
 namespace bloop::parser {
 	struct CParserContext;
-	class CParserSubExpression;
-	class CParserOperand;
-	struct COperator;
-
-	// when an expression contains a comma, this helper class will resolve them to a list of elements (fn call, array) or 
-	// merge into a continuous AST
-	struct CExpressionChain {
-		BLOOP_NONCOPYABLE(CExpressionChain);
-
-		CExpressionChain();
-		~CExpressionChain();
-
-		//(function calls, arrays, objects): returns all comma separated elements
-		[[nodiscard]] std::vector<UniqueExpression> ToList();
-
-		//(default): merges all comma separated expressions into one
-		[[nodiscard]] UniqueExpression ToMerged();
-
-		UniqueExpression m_pExpression;
-		std::unique_ptr<CExpressionChain> m_pNext;
-	};
 
+	// a precedence climbing parser, the ast is built in the same pass as the tokens are read
+	// operators bind by their EOperatorPriority, assignments to the right and everything else to the left
 	class CParserExpression : CParserSingle<bloop::CToken> {
 		BLOOP_NONCOPYABLE(CParserExpression);
-		using Operands = std::vector<CParserOperand*>;
-		using Operators = std::vector<COperator*>;
 	public:
 		CParserExpression() = delete;
 		CParserExpression(const CParserContext& ctx);
 		virtual ~CParserExpression();
 
-		[[nodiscard]] bloop::EStatus Parse(
-			std::optional<PairMatcher> eoe = std::nullopt,
-			CExpressionChain* expression = nullptr,
-			EEvaluationType evalType = EEvaluationType::evaluate_everything);
-
-		[[nodiscard]] bloop::EStatus ParseInternal(
-			std::optional<PairMatcher>& eoe,
-			CExpressionChain* expression = nullptr,
-			EEvaluationType evalType = EEvaluationType::evaluate_everything);
+		// without a closing punctuation the expression ends at a ";", which is left for the caller
+		// the closing punctuation is skipped
+		[[nodiscard]] bloop::EStatus Parse(std::optional<PairMatcher> eoe = std::nullopt);
 
+		//(default): merges all comma separated expressions into one
 		[[nodiscard]] UniqueExpression ToExpression();
+
+		//(function calls, arrays, objects): returns all comma separated elements
 		[[nodiscard]] std::vector<UniqueExpression> ToList();
 	protected:
 		[[nodiscard]] virtual constexpr bool IsStatement() const noexcept { return false; }
 		bloop::CodePosition m_oDeclPos;
 	private:
-		[[nodiscard]] UniqueExpression ToExpression_Internal();
+		// the operators that bind weaker than minPriority are left for the caller
+		// the root is the node that the whole comma separated element ends up in
+		[[nodiscard]] UniqueExpression ParseBinary(EOperatorPriority minPriority, bool isRoot);
+		[[nodiscard]] UniqueExpression ParseOperand();
 
-		[[nodiscard]] bool EndOfExpression(const std::optional<PairMatcher>& eoe) const noexcept;
+		// the binary operator at the current position, nullptr when the element ends there
+		[[nodiscard]] const bloop::CToken* NextOperator() const;
+		[[nodiscard]] bool EndOfExpression() const noexcept;
 
-		const CParserContext& m_oCtx;
-		std::vector<std::unique_ptr<CParserSubExpression>> m_oSubExpressions;
-		std::unique_ptr<CExpressionChain> m_pEvaluatedExpressions;
-
-		//EXPRESSION GENERATION
-		[[nodiscard]] UniqueExpression CreateExpression(Operands& operands, Operators& operators);
-		[[nodiscard]] UniqueExpression GetLeaf(Operands& operands);
-		[[nodiscard]] Operators::iterator FindLowestPriorityOperator(Operators& operators);
-		[[nodiscard]] void CreateExpressionRecursively(bloop::ast::BinaryExpression* _this, Operands& operands, Operators& operators);
-		[[nodiscard]] std::unique_ptr<bloop::ast::AssignExpression> MakeAssignment(bloop::CodePosition pos);
-		void SetBranch(UniqueExpression& getter, const bloop::CPunctuationToken* t);
+		[[nodiscard]] bloop::ast::NodePtr<bloop::ast::BinaryExpression> MakeOperator(const bloop::CToken* op, bool isRoot) const;
 
+		const CParserContext& m_oCtx;
+		std::optional<PairMatcher> m_oEndOfExpression;
+		std::vector<UniqueExpression> m_oExpressions; // comma separated
 	};
 
 	class CParserExpressionStatement : public CParserExpression, protected IStatement {
@@ -87,9 +60,8 @@ namespace bloop::parser {
 		~CParserExpressionStatement();
 
 		[[nodiscard]] UniqueStatement ToStatement() override;
-		constexpr void MakeNotStatement() { m_bIsStatement = false; }
 	private:
-		[[nodiscard]] constexpr bool IsStatement() const noexcept override { return m_bIsStatement; }
-		bool m_bIsStatement{ true };
+		// the root assignment doesn't have to leave its value behind
+		[[nodiscard]] constexpr bool IsStatement() const noexcept override { return true; }
 	};
-}
\ No newline at end of file
+}
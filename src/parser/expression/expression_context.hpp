@@ -26,9 +26,4 @@ namespace bloop::parser {
 	private:
 		EPunctuation m_eClosingPunctuation{ EPunctuation::p_error };
 	};
-
-	enum class EEvaluationType : signed char {
-		evaluate_everything,
-		evaluate_singular
-	};
 }
\ No newline at end of file
@@ -26,6 +26,6 @@ std::unique_ptr<IPostfix> CParserPostfix::ParseFunctionCall() {
 CPostfixFunctionCall::CPostfixFunctionCall(std::vector<UniqueExpression>&& args) : 
 	m_oArgs(std::forward<decltype(args)>(args)){}
 
-std::unique_ptr<BinaryExpression> CPostfixFunctionCall::ToExpression() {
-	return std::make_unique<bloop::ast::FunctionCall>(std::move(m_oArgs), m_oDeclPos);
+bloop::ast::NodePtr<BinaryExpression> CPostfixFunctionCall::ToExpression() {
+	return bloop::ast::Make<bloop::ast::FunctionCall>(std::move(m_oArgs), m_oDeclPos);
 }
\ No newline at end of file
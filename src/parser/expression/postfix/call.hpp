@@ -8,7 +8,7 @@ namespace bloop::parser {
 	struct CPostfixFunctionCall final : public IPostfix {
 		CPostfixFunctionCall() = default;
 		CPostfixFunctionCall(std::vector<UniqueExpression>&& args);
-		[[nodiscard]] std::unique_ptr<BinaryExpression> ToExpression() override;
+		[[nodiscard]] bloop::ast::NodePtr<BinaryExpression> ToExpression() override;
 	private:
 		std::vector<UniqueExpression> m_oArgs;
 	};
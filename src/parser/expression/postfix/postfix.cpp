@@ -40,7 +40,7 @@ bloop::EStatus CParserPostfix::Parse() {
 	std::ranges::reverse(m_oPostfixes);
 	return bloop::EStatus::success;
 }
-bool CParserPostfix::IsPostfixOperator(const CPunctuationToken* token) const noexcept
+bool CParserPostfix::IsPostfixOperator(const CToken* token) const noexcept
 {
 	return
 		token->m_ePriority == EOperatorPriority::op_postfix ||
@@ -19,7 +19,7 @@ namespace bloop::parser {
 		constexpr auto&& GetPostfixes() noexcept { return std::move(m_oPostfixes); }
 
 	private:
-		[[nodiscard]] bool IsPostfixOperator(const CPunctuationToken* token) const noexcept;
+		[[nodiscard]] bool IsPostfixOperator(const CToken* token) const noexcept;
 
 		[[nodiscard]] std::unique_ptr<IPostfix> ParseFunctionCall();
 		[[nodiscard]] std::unique_ptr<IPostfix> ParseSubscript();
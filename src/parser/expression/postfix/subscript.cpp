@@ -25,6 +25,6 @@ std::unique_ptr<IPostfix> CParserPostfix::ParseSubscript() {
 CPostfixSubscript::CPostfixSubscript(UniqueExpression&& index) :
 	m_pIndex(std::forward<decltype(index)>(index)){}
 
-std::unique_ptr<BinaryExpression> CPostfixSubscript::ToExpression() {
-	return std::make_unique<bloop::ast::Subscript>(std::move(m_pIndex), m_oDeclPos);
+bloop::ast::NodePtr<BinaryExpression> CPostfixSubscript::ToExpression() {
+	return bloop::ast::Make<bloop::ast::Subscript>(std::move(m_pIndex), m_oDeclPos);
 }
\ No newline at end of file
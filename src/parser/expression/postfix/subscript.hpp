@@ -8,7 +8,7 @@ namespace bloop::parser {
 	struct CPostfixSubscript final : public IPostfix {
 		CPostfixSubscript() = default;
 		CPostfixSubscript(UniqueExpression&& index);
-		[[nodiscard]] std::unique_ptr<BinaryExpression> ToExpression() override;
+		[[nodiscard]] bloop::ast::NodePtr<BinaryExpression> ToExpression() override;
 	private:
 		UniqueExpression m_pIndex;
 	};
@@ -27,17 +27,23 @@ bloop::EStatus CParserFunction::Parse() {
 }
 bloop::EStatus CParserFunction::ParseDeclaration() {
 
+	m_oDeclPos = GetIteratorSafe()->GetCodePosition();
+
+	if (!IsEndOfBuffer() && GetIteratorSafe()->Type() == ETokenType::tt_memo) {
+		m_bMemoize = true;
+		Advance(1); //skip memo
+	}
+
 	if (IsEndOfBuffer() || GetIteratorSafe()->Type() != ETokenType::tt_fn)
 		throw exception::ParserError(BLOOPTEXT("expected \"fn\""), GetIteratorSafe()->GetCodePosition());
 
-	m_oDeclPos = GetIteratorSafe()->GetCodePosition();
-
 	Advance(1); //skip fn
 
 	if (IsEndOfBuffer() || GetIteratorSafe()->Type() != ETokenType::tt_name)
 		throw exception::ParserError(BLOOPTEXT("expected an identifier"), GetIteratorSafe()->GetCodePosition());
 
 	m_sName = GetIteratorSafe()->Source();
+	m_uNameId = GetIteratorSafe()->NameId();
 
 	Advance(1); //skip identifier
 
@@ -68,7 +74,8 @@ bloop::EStatus CParserFunction::ParseParametersRecursively(std::vector<bloop::Bl
 	if (IsEndOfBuffer() || GetIteratorSafe()->Type() != ETokenType::tt_name)
 		throw exception::ParserError(BLOOPTEXT("expected an identifier"), GetIteratorSafe()->GetCodePosition());
 
-	receiver.push_back(GetIteratorSafe()->Source());
+	receiver.emplace_back(GetIteratorSafe()->Source());
+	m_oParameterIds.push_back(GetIteratorSafe()->NameId());
 	Advance(1); // skip identifier
 
 	if (GetIteratorSafe()->IsOperator(EPunctuation::p_comma)) {
@@ -95,5 +102,8 @@ bloop::EStatus CParserFunction::ParseScope() {
 }
 
 UniqueStatement CParserFunction::ToStatement() {
-	return std::make_unique<bloop::ast::FunctionDeclarationStatement>(m_sName, std::move(m_oParameters), std::move(m_pBody), m_oDeclPos);
+	auto func = bloop::ast::Make<bloop::ast::FunctionDeclarationStatement>(m_sName, m_uNameId, std::move(m_oParameters),
+		std::move(m_oParameterIds), std::move(m_pBody), m_oDeclPos);
+	func->m_bMemoize = m_bMemoize;
+	return func;
 }
\ No newline at end of file
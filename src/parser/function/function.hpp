@@ -32,7 +32,10 @@ namespace bloop::parser {
 
 		bloop::CodePosition m_oDeclPos;
 		bloop::BloopString m_sName;
+		bloop::BloopNameId m_uNameId{};
 		std::vector<bloop::BloopString> m_oParameters;
-		std::unique_ptr<bloop::ast::BlockStatement> m_pBody;
+		std::vector<bloop::BloopNameId> m_oParameterIds;
+		bloop::ast::NodePtr<bloop::ast::BlockStatement> m_pBody;
+		bool m_bMemoize{}; // declared with "memo fn"
 	};
 }
\ No newline at end of file
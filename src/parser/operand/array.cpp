@@ -21,5 +21,5 @@ CArrayOperand::CArrayOperand(std::vector<UniqueExpression>&& expr)
 CArrayOperand::~CArrayOperand() = default;
 
 UniqueExpression CArrayOperand::ToExpression() {
-	return std::make_unique<bloop::ast::ArrayExpression>(std::move(m_pInitializers), m_oDeclPos);
+	return bloop::ast::Make<bloop::ast::ArrayExpression>(std::move(m_pInitializers), m_oDeclPos);
 }
\ No newline at end of file
@@ -8,13 +8,13 @@
 using namespace bloop::parser;
 
 std::unique_ptr<IOperand> CParserOperand::ParseConstant() {
-	auto&& v = std::make_unique<CConstantOperand>(*m_iterPos);
+	auto&& v = std::make_unique<CConstantOperand>(m_iterPos);
 	Advance(1);
 	return v;
 }
 
-std::unique_ptr<ASTExpression> CConstantOperand::ToExpression(){
-	auto&& ptr = std::make_unique<bloop::ast::LiteralExpression>(m_oDeclPos);
+bloop::ast::NodePtr<ASTExpression> CConstantOperand::ToExpression(){
+	auto&& ptr = bloop::ast::Make<bloop::ast::LiteralExpression>(m_oDeclPos);
 	ptr->m_eDataType = GetType();
 	ptr->m_pConstant = ToData();
 	return ptr;
@@ -64,11 +64,11 @@ std::size_t CConstantOperand::GetSize() const noexcept {
 bloop::BloopString CConstantOperand::ToData() const noexcept {
 
 	if (GetType() == EValueType::t_string)
-		return m_pToken->Source();
+		return bloop::BloopString(m_pToken->Source());
 
 	BloopString result;
 	BloopDouble dvalue;
-	BloopString string = m_pToken->Source();
+	BloopString string(m_pToken->Source());
 
 	switch (GetType()) {
 	case EValueType::t_undefined:
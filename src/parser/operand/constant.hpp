@@ -12,7 +12,7 @@ namespace bloop::parser {
 	struct CConstantOperand final : public IOperand {
 		CConstantOperand(const bloop::CToken* token) : m_pToken(token) {}
 
-		[[nodiscard]] std::unique_ptr<ASTExpression> ToExpression() override;
+		[[nodiscard]] bloop::ast::NodePtr<ASTExpression> ToExpression() override;
 
 	private:
 
@@ -4,13 +4,14 @@
 using namespace bloop::parser;
 
 std::unique_ptr<IOperand> CParserOperand::ParseIdentifier() {
-	auto&& v = std::make_unique<CIdentifierOperand>((*m_iterPos)->Source());
+	auto&& v = std::make_unique<CIdentifierOperand>(bloop::BloopString(m_iterPos->Source()), m_iterPos->NameId());
 	Advance(1);
 	return v;
 }
 
-std::unique_ptr<ASTExpression> CIdentifierOperand::ToExpression(){
-	auto&& ptr = std::make_unique<bloop::ast::IdentifierExpression>(m_oDeclPos);
+bloop::ast::NodePtr<ASTExpression> CIdentifierOperand::ToExpression(){
+	auto&& ptr = bloop::ast::Make<bloop::ast::IdentifierExpression>(m_oDeclPos);
 	ptr->m_sName = m_sName;
+	ptr->m_uNameId = m_uNameId;
 	return ptr;
 }
\ No newline at end of file
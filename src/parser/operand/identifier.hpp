@@ -5,11 +5,12 @@
 
 namespace bloop::parser {
 	struct CIdentifierOperand final : public IOperand {
-		CIdentifierOperand(const bloop::BloopString& name) : m_sName(name) {}
+		CIdentifierOperand(const bloop::BloopString& name, bloop::BloopNameId id) : m_sName(name), m_uNameId(id) {}
 
-		[[nodiscard]] std::unique_ptr<ASTExpression> ToExpression() override;
+		[[nodiscard]] bloop::ast::NodePtr<ASTExpression> ToExpression() override;
 	private:
 		bloop::BloopString m_sName{};
+		bloop::BloopNameId m_uNameId{};
 	};
 
 }
\ No newline at end of file
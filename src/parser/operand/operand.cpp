@@ -30,7 +30,7 @@ bloop::EStatus CParserOperand::Parse([[maybe_unused]]std::optional<PairMatcher>&
 	} else if (token->Type() == ETokenType::tt_name) {
 		m_pOperand = ParseIdentifier();
 	} else {
-		throw exception::ParserError(BLOOPTEXT("unsupported: ") + token->Source(), token->GetCodePosition());
+		throw exception::ParserError(BLOOPTEXT("unsupported: ") + bloop::BloopString(token->Source()), token->GetCodePosition());
 	}
 
 	//because it got overwritten
@@ -53,15 +53,15 @@ static bloop::ast::BinaryExpression* SeekASTLeftBranch(bloop::ast::BinaryExpress
 	auto end = src;
 
 	while (end->left) {
-		end = dynamic_cast<bloop::ast::BinaryExpression*>(end->left.get());
+		end = bloop::ast::As<bloop::ast::BinaryExpression>(end->left.get());
 	}
 	assert(end);
 	return end;
 
 }
-std::unique_ptr<ASTExpression> CParserOperand::ToExpression() {
+bloop::ast::NodePtr<ASTExpression> CParserOperand::ToExpression() {
 
-	std::unique_ptr<BinaryExpression> entry;
+	bloop::ast::NodePtr<BinaryExpression> entry;
 
 	if (auto&& pfs = PostfixesToAST()) {
 		if (!entry)
@@ -73,15 +73,15 @@ std::unique_ptr<ASTExpression> CParserOperand::ToExpression() {
 	if (!entry) //no unaries nor postfixes
 		return GetOperand()->ToExpression();
 
-	SeekASTLeftBranch(dynamic_cast<bloop::ast::BinaryExpression*>(entry.get()))->left = GetOperand()->ToExpression();
+	SeekASTLeftBranch(bloop::ast::As<bloop::ast::BinaryExpression>(entry.get()))->left = GetOperand()->ToExpression();
 	return entry;
 }
-std::unique_ptr<BinaryExpression> CParserOperand::PostfixesToAST() const noexcept {
+bloop::ast::NodePtr<BinaryExpression> CParserOperand::PostfixesToAST() const noexcept {
 
 	if (m_oPostfixes.empty())
 		return nullptr;
 
-	std::unique_ptr<bloop::ast::BinaryExpression> root;;
+	bloop::ast::NodePtr<bloop::ast::BinaryExpression> root;;
 	bloop::ast::BinaryExpression* position{};
 
 	for (auto& pf : m_oPostfixes) {
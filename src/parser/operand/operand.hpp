@@ -27,7 +27,7 @@ namespace bloop::parser {
 		IntfOperand() = default;
 		virtual ~IntfOperand() = default;
 
-		[[nodiscard]] virtual std::unique_ptr<T> ToExpression() = 0;
+		[[nodiscard]] virtual bloop::ast::NodePtr<T> ToExpression() = 0;
 	protected:
 		bloop::CodePosition m_oDeclPos;
 	};
@@ -44,7 +44,7 @@ namespace bloop::parser {
 		[[nodiscard]] bloop::EStatus Parse(std::optional<PairMatcher>& eoe);
 
 		[[nodiscard]] constexpr auto& GetOperand() noexcept { return m_pOperand; }
-		[[nodiscard]] std::unique_ptr<ASTExpression> ToExpression();
+		[[nodiscard]] bloop::ast::NodePtr<ASTExpression> ToExpression();
 
 	private:
 		[[nodiscard]] std::unique_ptr<IOperand> ParseConstant();
@@ -52,7 +52,7 @@ namespace bloop::parser {
 		[[nodiscard]] std::unique_ptr<IOperand> ParseParentheses();
 		[[nodiscard]] std::unique_ptr<IOperand> ParseArray();
 
-		[[nodiscard]] std::unique_ptr<BinaryExpression> PostfixesToAST() const noexcept;
+		[[nodiscard]] bloop::ast::NodePtr<BinaryExpression> PostfixesToAST() const noexcept;
 
 		const CParserContext& m_oCtx;
 		std::unique_ptr<IOperand> m_pOperand;
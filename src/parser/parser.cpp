@@ -21,11 +21,9 @@
 using namespace bloop::parser;
 
 CLexParser::CLexParser(const bloop::lexer::CLexer& lexer) {
-	for (auto& t : lexer.GetTokens())
-		m_oTokens.push_back(t.get());
-
-	m_iterPos = m_oTokens.begin();
-	m_iterEnd = m_oTokens.end();
+	const auto& tokens = lexer.GetTokens();
+	m_iterPos = tokens.data();
+	m_iterEnd = tokens.data() + tokens.size();
 
 	m_pInternal = std::make_unique<CLexParserInternal>(m_iterPos, m_iterEnd);
 }
@@ -43,6 +41,7 @@ CLexParserInternal::~CLexParserInternal() = default;
 std::unique_ptr<bloop::ast::Program> CLexParserInternal::Parse()
 {
 	auto&& program = std::make_unique<ast::Program>(GetIteratorSafe()->GetCodePosition());
+	const ast::Arena::Scope scope(program->m_oArena);
 
 	auto ctx = CParserContext{
 		.m_iterPos = m_iterPos,
@@ -103,6 +102,7 @@ bloop::EStatus bloop::parser::ParseToken(const CParserContext& ctx) {
 	case ETokenType::tt_operator:
 		return ParseOperator(ctx);
 	case ETokenType::tt_fn:
+	case ETokenType::tt_memo:
 		return CreateParser<CParserFunction>(ctx);
 	case ETokenType::tt_let:
 	case ETokenType::tt_const:
@@ -121,6 +121,6 @@ bloop::EStatus bloop::parser::ParseToken(const CParserContext& ctx) {
 	case ETokenType::tt_break:
 		return CreateParser<CParserControlStatement>(ctx);
 	default:
-		throw exception::ParserError(BLOOPTEXT("unexpected token: ") + ctx.GetIterator()->Source(), ctx.GetIterator()->GetCodePosition());
+		throw exception::ParserError(BLOOPTEXT("unexpected token: ") + bloop::BloopString(ctx.GetIterator()->Source()), ctx.GetIterator()->GetCodePosition());
 	}
 }
\ No newline at end of file
@@ -20,7 +20,7 @@ namespace bloop::parser {
 		ParserIterator& m_iterEnd;
 		mutable bloop::ast::BlockStatement* m_pCurrentBlock;
 
-		auto& GetIterator() const noexcept { return *m_iterPos; }
+		auto GetIterator() const noexcept { return m_iterPos; }
 	};
 
 	class CLexParserInternal;
@@ -33,7 +33,6 @@ namespace bloop::parser {
 		[[nodiscard]] std::unique_ptr<bloop::ast::Program> Parse();
 
 	private:
-		std::vector<bloop::CToken*> m_oTokens;
 		std::unique_ptr<CLexParserInternal> m_pInternal;
 		ParserIterator m_iterPos, m_iterEnd;
 	};
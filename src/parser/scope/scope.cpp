@@ -14,11 +14,11 @@ CParserScope::CParserScope(const CParserContext& ctx)
 }
 CParserScope::~CParserScope() = default;
 
-std::unique_ptr<bloop::ast::UnnamedScopeStatement> CParserScope::Parse(bool allowSingleStatement) {
+bloop::ast::NodePtr<bloop::ast::UnnamedScopeStatement> CParserScope::Parse(bool allowSingleStatement) {
 
 	const auto [ iterPos, isCurlyBracket ] = ParseFirstPart(allowSingleStatement);
 
-	auto block = std::make_unique<bloop::ast::UnnamedScopeStatement>(iterPos);
+	auto block = bloop::ast::Make<bloop::ast::UnnamedScopeStatement>(iterPos);
 	auto oldBlock = m_oCtx.m_pCurrentBlock;
 	m_oCtx.m_pCurrentBlock = block.get();
 
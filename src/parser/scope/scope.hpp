@@ -27,7 +27,7 @@ namespace bloop::parser {
 		CParserScope(const CParserContext& ctx);
 		~CParserScope();
 
-		[[nodiscard]] std::unique_ptr<bloop::ast::UnnamedScopeStatement> Parse(bool allowSingleStatement=false);
+		[[nodiscard]] bloop::ast::NodePtr<bloop::ast::UnnamedScopeStatement> Parse(bool allowSingleStatement=false);
 		
 		//append to current scope
 		void ParseNoScope(bool allowSingleStatement = false);
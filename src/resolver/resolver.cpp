@@ -1,9 +1,10 @@
 #include "resolver/resolver.hpp"
 #include "ast/function.hpp"
+#include "ast/postfix.hpp"
 
 #include <cassert>
 #include <ranges>
-#include <list>
+#include <span>
 
 #define NOMINMAX
 
@@ -14,7 +15,7 @@ void bloop::resolver::Resolve(bloop::ast::Program* code){
 
 	//clear out any silly business
 	for (auto& globalStatement : code->m_oStatements) {
-		if (dynamic_cast<bloop::ast::UnnamedScopeStatement*>(globalStatement.get()))
+		if (bloop::ast::As<bloop::ast::UnnamedScopeStatement>(globalStatement.get()))
 			throw exception::ResolverError(BLOOPTEXT("unnamed scopes aren't allowed in the global scope"), globalStatement->m_oApproximatePosition);
 
 	}
@@ -23,113 +24,242 @@ void bloop::resolver::Resolve(bloop::ast::Program* code){
 		throw exception::ResolverError(bloop::fmt::format(BLOOPTEXT("the code has more than {} functions"), bloop::INVALID_SLOT));
 
 	code->Resolve(resolver);
+	resolver.AnalyzeEscapes();
+	resolver.AnalyzePurity();
 	code->m_uNumFunctions = static_cast<bloop::BloopIndex>(resolver.m_oAllFunctions.size());
 }
 
 using namespace bloop::resolver::internal;
 
 void Resolver::BeginScope() {
-	m_oScopes.emplace_back();
+	m_oScopes.push_back({ .m_uFirstSymbol = m_oDeclared.size() });
 	m_iScopeDepth++;
+
+	if (!m_oFunctions.empty())
+		m_oScopes.back().m_uFirstSlot = m_oFunctions.back().m_uNextSlot;
 }
 void Resolver::EndScope() {
 	assert(!m_oScopes.empty());
+
+	// the next sibling scope can reuse the slots, except the ones that closures still point to
+	if (!m_oFunctions.empty()) {
+		auto& func = m_oFunctions.back();
+		auto nextSlot = m_oScopes.back().m_uFirstSlot;
+
+		for (const auto slot : func.m_pCurrentFunction->m_oPinnedSlots) {
+			if (slot >= nextSlot && slot < func.m_uNextSlot)
+				nextSlot = slot + 1u;
+		}
+		func.m_uNextSlot = nextSlot;
+	}
+
+	// the symbols stay alive, only their names stop being visible
+	for (auto i = m_oDeclared.size(); i > m_oScopes.back().m_uFirstSymbol; i--) {
+		const auto* sym = m_oDeclared[i - 1u];
+		m_oBindings[sym->m_uNameId] = sym->m_pShadowed;
+	}
+	m_oDeclared.resize(m_oScopes.back().m_uFirstSymbol);
+
 	m_oScopes.pop_back();
 	m_iScopeDepth--;
 }
-Symbol* Resolver::DeclareSymbol(const bloop::BloopString& name, bool isConst) {
-	auto& scope = m_oScopes.back().symbols;
+Symbol* Resolver::DeclareSymbol(const bloop::BloopString& name, bloop::BloopNameId id, bool isConst) {
+	const auto numSymbols = m_oDeclared.size() - m_oScopes.back().m_uFirstSymbol; // in this scope
 
 	if (!m_oFunctions.empty() && m_oFunctions.back().m_uNextSlot >= std::numeric_limits<bloop::BloopIndex>::max())
 		throw exception::ResolverError(BLOOPTEXT("too many locals in a function (most recent): ") + name);
 
 	bloop::BloopIndex slot{};
 	if (m_oFunctions.empty()) {
-		if (scope.size() >= bloop::INVALID_SLOT)
+		if (numSymbols >= bloop::INVALID_SLOT)
 			throw exception::ResolverError(bloop::fmt::format(BLOOPTEXT("the code has more than {} globals"), bloop::INVALID_SLOT));
 
-		slot = static_cast<bloop::BloopIndex>(scope.size());
+		slot = static_cast<bloop::BloopIndex>(numSymbols);
 	} else {
 		if (m_oFunctions.back().m_uNextSlot >= bloop::INVALID_SLOT) {
 			throw exception::ResolverError(bloop::fmt::format(BLOOPTEXT("the function \"{}\" has more than {} symbols"),
 				m_oFunctions.back().m_pCurrentFunction->m_sName, bloop::INVALID_SLOT));
 		}
 		slot = m_oFunctions.back().m_uNextSlot++;
+		m_oFunctions.back().m_uNumSlots = std::max(m_oFunctions.back().m_uNumSlots, m_oFunctions.back().m_uNextSlot);
 	}
-	auto& result = (scope[name] = std::make_shared<Symbol>(name, m_iScopeDepth, slot, isConst));
-	return result.get();
+
+	if (id >= m_oBindings.size())
+		m_oBindings.resize(static_cast<std::size_t>(id) + 1u);
+
+	auto& binding = m_oBindings[id];
+	auto& result = m_oSymbols.emplace_back(Symbol{ .m_sName = name, .m_uNameId = id, .m_iDepth = m_iScopeDepth, .m_uSlot = slot,
+		.m_bIsConst = isConst, .m_pShadowed = binding });
+
+	binding = &result;
+	m_oDeclared.push_back(&result);
+	return &result;
 }
-Symbol* Resolver::ResolveSymbol(const bloop::BloopString& name) {
+Symbol* Resolver::ResolveSymbol(bloop::BloopNameId id) {
 	
 	//exit early if it exists in this scope
 
-	if (auto* local = ResolveLocal(name))
+	if (auto* local = ResolveLocal(id))
 		return local;
 
-	if (auto* global = ResolveGlobal(name))
+	if (auto* global = ResolveGlobal(id))
 		return global;
 
-	return ResolveOuter(name);
+	return ResolveOuter(id);
 }
-ResolvedIdentifier Resolver::ResolveIdentifier(const bloop::BloopString& name) {
+ResolvedIdentifier Resolver::ResolveIdentifier(bloop::BloopNameId id) {
 
-	if (auto* sym = ResolveLocal(name))
-		return { ResolvedIdentifier::Kind::Local, sym->m_uSlot, sym->m_bIsConst };
+	if (auto* sym = ResolveLocal(id))
+		return { ResolvedIdentifier::Kind::Local, sym->m_uSlot, sym->m_bIsConst, sym, sym->m_pDeclaration };
 
-	if (auto* sym = ResolveGlobal(name))
-		return { ResolvedIdentifier::Kind::Global, sym->m_uSlot, sym->m_bIsConst };
+	if (auto* sym = ResolveGlobal(id))
+		return { ResolvedIdentifier::Kind::Global, sym->m_uSlot, sym->m_bIsConst, sym, sym->m_pDeclaration };
 
-	if (auto* sym = ResolveOuter(name)) {
+	if (auto* sym = ResolveOuter(id)) {
 
-		auto funcs = m_oFunctions | std::views::drop(sym->m_iDepth);
-		auto t = std::list<FunctionContext>(funcs.begin(), funcs.end());
+		// skip the function that owns the symbol and everything around it
+		// the depth is a scope depth, so nested blocks don't map 1:1 to functions
+		const auto owners = std::ranges::count_if(m_oFunctions, [sym](const FunctionContext& f) {
+			return f.m_pCurrentFunction->m_iScopeDepth <= sym->m_iDepth; });
 
-		t.front().m_pCurrentFunction->PropagateCaptureInward(nullptr, t, sym);
+		// the owner has to keep it in its frame slot for the closures to find it
+		if (owners > 0)
+			m_oFunctions[owners - 1].m_pCurrentFunction->m_oPinnedSlots.insert(sym->m_uSlot);
+
+		const auto inner = std::span<const FunctionContext>(m_oFunctions).subspan(static_cast<std::size_t>(owners));
+
+		inner.front().m_pCurrentFunction->PropagateCaptureInward(nullptr, inner, sym);
 		return ResolvedIdentifier{ 
-			ResolvedIdentifier::Kind::Upvalue, 
+			sym->IsCapturedByValue() ? ResolvedIdentifier::Kind::CapturedConst : ResolvedIdentifier::Kind::Upvalue, 
 			m_oFunctions.back().m_pCurrentFunction->m_uNextUpValues->at(sym),
-			sym->m_bIsConst
+			sym->m_bIsConst,
+			sym,
+			sym->m_pDeclaration
 		};
 	}
 
 	return ResolvedIdentifier{ ResolvedIdentifier::Kind::Error, {}, false };
 }
 
-Symbol* Resolver::ResolveLocal(const bloop::BloopString& name) {
-	//if (m_oScopes.back().symbols.contains(name))
-	//	return m_oScopes.back().symbols.at(name).get();
+Symbol* Resolver::ResolveLocal(bloop::BloopNameId id) const noexcept {
 
 	if (m_oFunctions.empty())
 		return nullptr;
 
-	auto& func = m_oFunctions.back().m_pCurrentFunction;
-	auto range = std::vector<Scope>(m_oScopes.begin() + func->m_iScopeDepth, m_oScopes.end());
+	// the innermost binding belongs to this function if it was declared in one of its scopes
+	auto* sym = ResolveOuter(id);
+	return sym && sym->m_iDepth >= m_oFunctions.back().m_pCurrentFunction->m_iScopeDepth ? sym : nullptr;
+}
+Symbol* Resolver::ResolveGlobal(bloop::BloopNameId id) const noexcept {
 
-	if (const auto itr = std::ranges::find_if(range.rbegin(), range.rend(), [&name](Scope& s) {
-		return s.symbols.contains(name); }); itr != range.rend()) {
-		return itr->symbols.at(name).get();
-	}
+	// a global can only be the outermost binding
+	auto* sym = ResolveOuter(id);
+	while (sym && sym->m_pShadowed)
+		sym = sym->m_pShadowed;
 
-	return nullptr;
-}
-Symbol* Resolver::ResolveGlobal(const bloop::BloopString& name) {
-	if (m_oScopes.front().symbols.contains(name))
-		return m_oScopes.front().symbols.at(name).get();
-	return nullptr;
+	return sym && sym->m_iDepth == 0 ? sym : nullptr;
 }
-Symbol* Resolver::ResolveOuter(const bloop::BloopString& name)
+Symbol* Resolver::ResolveOuter(bloop::BloopNameId id) const noexcept
 {
-	const auto itr = std::ranges::find_if(m_oScopes.rbegin(), m_oScopes.rend(), [&name](Scope& s) {
-		return s.symbols.contains(name);
-	});
-
-	if (itr == m_oScopes.rend())
-		return nullptr;
-
-	return itr->symbols.at(name).get();
+	return id < m_oBindings.size() ? m_oBindings[id] : nullptr;
 }
 
 bloop::ast::FunctionDeclarationStatement* Resolver::GetOuterMostFunction() const {
 	assert(!m_oFunctions.empty());
 	return m_oFunctions.front().m_pCurrentFunction;
-}
\ No newline at end of file
+}
+void Resolver::AddFunctionUse(const ResolvedIdentifier& identifier, bloop::ast::FunctionCall* directCall) {
+	if (!identifier.m_pSymbol || !identifier.m_pSymbol->m_pFunction)
+		return;
+
+	m_oFunctionUses[identifier.m_pSymbol->m_pFunction].push_back({
+		.m_pUser = m_oFunctions.empty() ? nullptr : m_oFunctions.back().m_pCurrentFunction,
+		.m_pDirectCall = directCall
+	});
+}
+
+void Resolver::AnalyzeEscapes() {
+
+	using Capture = bloop::ast::Capture;
+
+	const auto HasUpvalueCapture = [](const bloop::ast::FunctionDeclarationStatement* f) {
+		return std::ranges::any_of(f->m_oCaptures, [](const Capture& c) { return c.kind == Capture::Kind::Upvalue; });
+	};
+
+	for (auto* func : m_oAllFunctions) {
+
+		// without captures it's already just an immortal handle
+		if (!func->m_pEnclosingFunction || func->m_oCaptures.empty())
+			continue;
+
+		// the enclosing frame has no closure to forward upvalues from
+		if (HasUpvalueCapture(func))
+			continue;
+
+		if (std::ranges::any_of(m_oAllFunctions, [&](const bloop::ast::FunctionDeclarationStatement* nested) {
+			return nested->m_pEnclosingFunction == func && HasUpvalueCapture(nested); }))
+			continue;
+
+		// only calls made from the declaring function's own frame can read its stack slots
+		const auto& uses = m_oFunctionUses[func];
+		const auto escapes = std::ranges::any_of(uses, [func](const FunctionUse& use) {
+			return !use.m_pDirectCall || use.m_pUser != func->m_pEnclosingFunction 
+				|| use.m_pDirectCall->m_oArguments.size() != func->m_oParams.size();
+		});
+
+		if (escapes)
+			continue;
+
+		func->m_bEscapes = false;
+		for (const auto& use : uses)
+			use.m_pDirectCall->m_uEnclosedFunction = func->m_uFunctionId;
+	}
+}
+
+void Resolver::MarkImpure() {
+	if (!m_oFunctions.empty())
+		m_oImpureFunctions.insert(m_oFunctions.back().m_pCurrentFunction);
+}
+
+void Resolver::AnalyzePurity() {
+
+	std::unordered_set<const bloop::ast::FunctionDeclarationStatement*> pure;
+
+	for (auto* func : m_oAllFunctions) {
+
+		// closures depend on more than their arguments
+		if (func->m_pEnclosingFunction || !func->m_oCaptures.empty() || m_oImpureFunctions.contains(func))
+			continue;
+
+		// declared in the global scope itself, so the optimizer can find it among the global statements
+		if (func->m_iScopeDepth != 1)
+			continue;
+
+		if (std::ranges::any_of(m_oAllFunctions, [func](const bloop::ast::FunctionDeclarationStatement* nested) {
+			return nested->m_pEnclosingFunction == func; }))
+			continue;
+
+		pure.insert(func);
+	}
+
+	// using an impure function makes the user impure too
+	for (auto changed = true; changed; ) {
+		changed = false;
+
+		for (const auto& [func, uses] : m_oFunctionUses) {
+			if (pure.contains(func))
+				continue;
+
+			for (const auto& use : uses)
+				changed |= use.m_pUser && pure.erase(use.m_pUser) > 0u;
+		}
+	}
+
+	for (auto* func : m_oAllFunctions) {
+		func->m_bPure = pure.contains(func);
+
+		// a cached result would hide whatever else the function depends on
+		if (func->m_bMemoize && !func->m_bPure)
+			throw exception::ResolverError(BLOOPTEXT("a memo function has to be pure: ") + func->m_sName, func->m_oApproximatePosition);
+	}
+}
@@ -2,12 +2,17 @@
 
 #include "utils/defs.hpp"
 
+#include <deque>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace bloop::ast {
 	struct Program;
 	struct FunctionDeclarationStatement;
+	struct FunctionCall;
+	struct VariableDeclaration;
 }
 
 namespace bloop::resolver {
@@ -18,18 +23,27 @@ namespace bloop::resolver {
 
 		struct Symbol {
 			bloop::BloopString m_sName;
+			bloop::BloopNameId m_uNameId{};
 			bloop::BloopInt m_iDepth{};
 			bloop::BloopIndex m_uSlot{};
 			bloop::BloopBool m_bIsConst{};
+			bloop::ast::FunctionDeclarationStatement* m_pFunction{}; // when declared by a function declaration
+			const bloop::ast::VariableDeclaration* m_pDeclaration{}; // when declared by a variable declaration
+			Symbol* m_pShadowed{}; // the binding of the same name in an outer scope, visible again when this one's scope ends
+
+			// a const variable can't change after its declaration, so closures can keep a copy
+			// functions are excluded, because they can capture themselves before they are stored
+			[[nodiscard]] constexpr bool IsCapturedByValue() const noexcept { return m_bIsConst && !m_pFunction; }
 		};
 
 		struct Scope {
-
-			std::unordered_map<bloop::BloopString, std::shared_ptr<Symbol>> symbols;
+			std::size_t m_uFirstSymbol{}; // where the scope's symbols start in the declaration stack
+			bloop::BloopIndex m_uFirstSlot{}; // of the function that was being resolved when the scope began
 		};
 		struct FunctionContext {
 			bloop::BloopIndex m_uNextSlot = 0;
 			bloop::ast::FunctionDeclarationStatement* m_pCurrentFunction{};
+			bloop::BloopIndex m_uNumSlots = 0; // the most slots that were in use at once
 
 
 
@@ -37,10 +51,18 @@ namespace bloop::resolver {
 
 
 		struct ResolvedIdentifier {
-			enum class Kind { Error, Local, Upvalue, Global };
+			enum class Kind { Error, Local, Upvalue, CapturedConst, Global };
 			Kind m_eKind;
 			bloop::BloopIndex m_uSlot;
 			bool m_bConst{};
+			const Symbol* m_pSymbol{}; // only valid during resolution, the resolver owns the symbols
+			const bloop::ast::VariableDeclaration* m_pDeclaration{};
+		};
+
+		// every place where a function is referenced by its name
+		struct FunctionUse {
+			bloop::ast::FunctionDeclarationStatement* m_pUser{}; // nullptr in the global scope
+			bloop::ast::FunctionCall* m_pDirectCall{}; // nullptr if the value is used for anything else than a call
 		};
 		struct Resolver {
 			std::vector<Scope> m_oScopes;
@@ -51,18 +73,40 @@ namespace bloop::resolver {
 			void BeginScope();
 			void EndScope();
 
-			[[maybe_unused]] Symbol* DeclareSymbol(const bloop::BloopString& name, bool isConst = false);
-			[[nodiscard]] Symbol* ResolveSymbol(const bloop::BloopString& name);
-			[[nodiscard]] ResolvedIdentifier ResolveIdentifier(const bloop::BloopString& name);
+			[[maybe_unused]] Symbol* DeclareSymbol(const bloop::BloopString& name, bloop::BloopNameId id, bool isConst = false);
+			[[nodiscard]] Symbol* ResolveSymbol(bloop::BloopNameId id);
+			[[nodiscard]] ResolvedIdentifier ResolveIdentifier(bloop::BloopNameId id);
 
 			[[nodiscard]] bloop::ast::FunctionDeclarationStatement* GetOuterMostFunction() const;
 
+			void AddFunctionUse(const ResolvedIdentifier& identifier, bloop::ast::FunctionCall* directCall);
+
+			// marks closures that are only ever called by the function that declares them
+			void AnalyzeEscapes();
+
+			// the function being resolved touches something that a compile time call can't see
+			void MarkImpure();
+
+			// marks global functions whose result only depends on their arguments
+			void AnalyzePurity();
+
 			std::vector<bloop::ast::FunctionDeclarationStatement*> m_oAllFunctions;
+			std::unordered_map<const bloop::ast::FunctionDeclarationStatement*, std::vector<FunctionUse>> m_oFunctionUses;
+			std::unordered_set<const bloop::ast::FunctionDeclarationStatement*> m_oImpureFunctions;
 
 		private:
-			[[nodiscard]] Symbol* ResolveLocal(const bloop::BloopString& name);
-			[[nodiscard]] Symbol* ResolveGlobal(const bloop::BloopString& name);
-			[[nodiscard]] Symbol* ResolveOuter(const bloop::BloopString& name);
+			[[nodiscard]] Symbol* ResolveLocal(bloop::BloopNameId id) const noexcept;
+			[[nodiscard]] Symbol* ResolveGlobal(bloop::BloopNameId id) const noexcept;
+			[[nodiscard]] Symbol* ResolveOuter(bloop::BloopNameId id) const noexcept;
+
+			// every scope's symbols in one stack, the innermost scope's last
+			std::vector<Symbol*> m_oDeclared;
+
+			// the innermost visible symbol of each name id, the rest are reached through Symbol::m_pShadowed
+			std::vector<Symbol*> m_oBindings;
+
+			// doesn't move its symbols when it grows, captures use their addresses as keys
+			std::deque<Symbol> m_oSymbols;
 
 		};
 	}
@@ -39,8 +39,12 @@ namespace bloop {
 	using BloopIndex = bloop::BloopUInt64;
 #endif
 
+	using BloopNameId = bloop::BloopUInt32; // the lexer gives every distinct name in a script its own id
+
 #define BLOOP_MAX_STACK 0xffffu
 #define BLOOP_MAX_FRAMES 0x400u
+#define BLOOP_MEMO_CAPACITY 0x1000u // cached results per memo function
+#define BLOOP_LEX_CHUNK_SIZE 0x40000u // the smallest piece of a script that gets lexed on its own thread
 
 #if defined(_WIN32)
 #if defined(_WIN64)
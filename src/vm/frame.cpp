@@ -10,12 +10,17 @@ CallFrame::CallFrame(Chunk* fn, std::size_t stackBase)
 CallFrame::CallFrame(Closure* closure, std::size_t stackBase) 
 	: m_pClosure(closure), m_pChunk(&closure->function->chunk), m_uBase(stackBase) {}
 
-const CInstructionPosition& CallFrame::GetCurrentPosition() const {
-	auto it = std::upper_bound(m_pChunk->m_oPositions.begin(), m_pChunk->m_oPositions.end(), m_uIp,
+const CInstructionPosition* Chunk::FindPosition(std::size_t ip) const {
+	auto it = std::upper_bound(m_oPositions.begin(), m_oPositions.end(), ip,
 		[](std::size_t ip, const CInstructionPosition& p) {
 			return ip <= p.byteOffset;
 		});
-	return *(it - 1);
+	return it == m_oPositions.begin() ? nullptr : &*(it - 1);
+}
+const CInstructionPosition& CallFrame::GetCurrentPosition() const {
+	const auto pos = m_pChunk->FindPosition(m_uIp);
+	assert(pos);
+	return *pos;
 }
 
 void VM::PushFrame(Function* fn) {
@@ -28,6 +33,7 @@ void VM::PushFrame(Function* fn) {
 	if (m_oFrames.size() >= BLOOP_MAX_FRAMES)
 		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("exceeded {} call frames"), BLOOP_MAX_FRAMES));
 
+	ConsumeFuel();
 	m_oStack.resize(frameBase + fn->m_uLocalCount);
 	m_pCurrentFrame = &m_oFrames.emplace_back(&fn->chunk, frameBase);
 }
@@ -41,6 +47,7 @@ void VM::PushFrame(Closure* closure) {
 	if (m_oFrames.size() >= BLOOP_MAX_FRAMES)
 		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("exceeded {} call frames"), BLOOP_MAX_FRAMES));
 
+	ConsumeFuel();
 	m_oStack.resize(frameBase + closure->function->m_uLocalCount);
 	m_pCurrentFrame = &m_oFrames.emplace_back(closure, frameBase);
 }
@@ -50,6 +57,10 @@ void VM::PopFrame() {
 	m_oFrames.pop_back();
 	m_pCurrentFrame = m_oFrames.empty() ? nullptr : &m_oFrames.back();
 }
+void VM::ConsumeFuel() {
+	if (m_uFuel && --m_uFuel == 0u)
+		throw exception::VMError(BLOOPTEXT("ran out of fuel"));
+}
 void VM::Push(const Value& v) {
 	m_oStack.push_back(v);
 }
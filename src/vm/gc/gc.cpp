@@ -4,8 +4,70 @@
 #include "vm/heap/dvalue.hpp"
 
 #include <ranges>
+#include <unordered_map>
 
 using namespace bloop::vm;
+using EdgeKind = HeapSnapshot::EdgeKind;
+
+template<typename Callback>
+void GC::ForEachRoot(VM* vm, Callback&& callback) {
+
+	const auto Visit = [&](const Value& v, EdgeKind kind, std::size_t index) {
+		if (v.type == Value::Type::t_object)
+			callback(v.obj, kind, index);
+	};
+
+	for (const auto i : std::views::iota(0u, vm->m_oGlobals.size()))
+		Visit(vm->m_oGlobals[i], EdgeKind::ek_global, i);
+
+	for (const auto i : std::views::iota(0u, vm->m_oStack.size()))
+		Visit(vm->m_oStack[i], EdgeKind::ek_stack, i);
+
+	// constants of functions that aren't running can still be loaded later
+	// every chunk's constants are in the pool, so the chunks don't have to be visited
+	for (const auto i : std::views::iota(0u, vm->m_oConstants.size()))
+		Visit(vm->m_oConstants[i], EdgeKind::ek_constant, i);
+
+	for (const auto& func : vm->m_oFunctions) {
+		if (func.m_oMemo)
+			func.m_oMemo->ForEachValue([&Visit, i = std::size_t{}](const Value& v) mutable { Visit(v, EdgeKind::ek_memo, i++); });
+	}
+
+	for (const auto i : std::views::iota(0u, vm->m_oMemoArgs.size()))
+		Visit(vm->m_oMemoArgs[i], EdgeKind::ek_memo, i);
+
+	// an open upvalue is still referenced by the frame that owns the slot, even if its closure is gone
+	for (const auto slot : vm->m_oOpenSlots)
+		callback(vm->m_oOpenUpValues[slot], EdgeKind::ek_open_upvalue, slot);
+}
+template<typename Callback>
+void GC::ForEachReference(Object* obj, Callback&& callback) {
+
+	switch (obj->type) {
+	case Object::Type::ot_array:
+		for (const auto i : std::views::iota(0, obj->array.count)) {
+			if (obj->array.values[i].type == Value::Type::t_object)
+				callback(obj->array.values[i].obj, EdgeKind::ek_element, static_cast<std::size_t>(i));
+		}
+		break;
+	case Object::Type::ot_closure:
+		for (const auto i : std::views::iota(0u, obj->closure.numValues)) {
+			if (obj->closure.upvalues[i])
+				callback(obj->closure.upvalues[i], EdgeKind::ek_upvalue, i);
+		}
+		for (const auto i : std::views::iota(0u, obj->closure.numConstants)) {
+			if (obj->closure.constants[i].type == Value::Type::t_object)
+				callback(obj->closure.constants[i].obj, EdgeKind::ek_captured_const, i);
+		}
+		break;
+	case Object::Type::ot_upvalue:
+		if (obj->upvalue.location->type == Value::Type::t_object)
+			callback(obj->upvalue.location->obj, EdgeKind::ek_value, 0u);
+		break;
+	default:
+		break;
+	}
+}
 
 void GC::Collect(VM* vm) {
 
@@ -18,24 +80,7 @@ void GC::Collect(VM* vm) {
 	m_pHeap->m_uNextGCLimit = m_pHeap->m_uBytesAllocated * 2;
 }
 void GC::MarkRoots(VM* vm) {
-
-	for (auto& glob : vm->m_oGlobals) {
-		if (glob.type == Value::Type::t_object)
-			Mark(glob.obj);
-	}
-
-	for (auto& v : vm->m_oStack) {
-		if (v.type == Value::Type::t_object)
-			Mark(v.obj);
-	}
-
-	for (const auto& frame : vm->m_oFrames) {
-		for (auto& c : frame.m_pChunk->m_oConstants) {
-			if (c.type == Value::Type::t_object)
-				Mark(c.obj);
-		}
-	}
-
+	ForEachRoot(vm, [this](Object* obj, EdgeKind, std::size_t) { Mark(obj); });
 }
 void GC::Mark(Object* obj) {
 	if (!obj || obj->marked)
@@ -58,19 +103,66 @@ void GC::Sweep() {
 	}
 }
 void GC::Trace(Object* obj) {
+	ForEachReference(obj, [this](Object* ref, EdgeKind, std::size_t) { Mark(ref); });
+}
 
-	switch (obj->type) {
-	case Object::Type::ot_array: 
-		for (const auto i : std::views::iota(0, obj->array.count)) {
-			if (obj->array.values[i].type == Value::Type::t_object)
-				Mark(obj->array.values[i].obj);
-		}
-		break;
-	case Object::Type::ot_closure:
-		for (const auto i : std::views::iota(0u, obj->closure.numValues)) {
-			Mark(obj->closure.upvalues[i]->owner);
+HeapSnapshot GC::Snapshot(VM* vm) const {
+
+	HeapSnapshot snapshot;
+	snapshot.m_oNodes.push_back({ .m_uType = snapshot.InternString(BLOOPTEXT("<roots>")) });
+
+	std::unordered_map<const Chunk*, bloop::BloopString> chunkNames{ { &vm->m_oGlobalChunk, BLOOPTEXT("<global>") } };
+	for (const auto& func : vm->m_oFunctions)
+		chunkNames[&func.chunk] = func.m_sName;
+
+	std::unordered_map<const Object*, std::uint32_t> nodes;
+	std::unordered_map<const CInstructionPosition*, std::uint32_t> sites;
+	std::vector<Object*> pending;
+
+	const auto GetSite = [&](const Object* obj) {
+		if (!obj->allocChunk)
+			return HeapSnapshot::NO_SITE;
+
+		const auto pos = obj->allocChunk->FindPosition(obj->allocIp);
+		if (!pos)
+			return HeapSnapshot::NO_SITE;
+
+		if (const auto it = sites.find(pos); it != sites.end())
+			return it->second;
+
+		snapshot.m_oSites.push_back({ chunkNames[obj->allocChunk], std::get<0>(pos->pos), std::get<1>(pos->pos) });
+		return sites[pos] = static_cast<std::uint32_t>(snapshot.m_oSites.size() - 1u);
+	};
+
+	const auto AddEdge = [&](std::uint32_t from, Object* to, EdgeKind kind, std::size_t index) {
+
+		auto it = nodes.find(to);
+		if (it == nodes.end()) {
+			it = nodes.emplace(to, static_cast<std::uint32_t>(snapshot.m_oNodes.size())).first;
+			snapshot.m_oNodes.push_back({
+				.m_uAddress = reinterpret_cast<std::uintptr_t>(to),
+				.m_uType = snapshot.InternString(to->TypeToString()),
+				.m_uSite = GetSite(to),
+				.m_uSize = to->GetSize()
+			});
+			pending.push_back(to);
 		}
-		break;
+		snapshot.m_oEdges.push_back({ from, it->second, kind, static_cast<std::uint32_t>(index) });
+	};
+
+	ForEachRoot(vm, [&](Object* obj, EdgeKind kind, std::size_t index) {
+		AddEdge(HeapSnapshot::ROOT_NODE, obj, kind, index);
+	});
+
+	while (!pending.empty()) {
+		Object* obj = pending.back();
+		pending.pop_back();
+
+		const auto from = nodes.at(obj);
+		ForEachReference(obj, [&](Object* ref, EdgeKind kind, std::size_t index) {
+			AddEdge(from, ref, kind, index);
+		});
 	}
 
-}
\ No newline at end of file
+	return snapshot;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "utils/defs.hpp"
+#include "vm/heap/snapshot.hpp"
 
 namespace bloop::vm
 {
@@ -17,12 +18,21 @@ namespace bloop::vm
 
 		void Collect(VM* vm);
 
+		// walks the same graph as the mark phase without touching the mark bits
+		[[nodiscard]] HeapSnapshot Snapshot(VM* vm) const;
+
 	private:
 		void MarkRoots(VM* vm);
 		void Mark(Object* obj);
 		void Sweep();
 		void Trace(Object* obj);
 
+		// callback(Object*, HeapSnapshot::EdgeKind, index)
+		template<typename Callback>
+		static void ForEachRoot(VM* vm, Callback&& callback);
+		template<typename Callback>
+		static void ForEachReference(Object* obj, Callback&& callback);
+
 		Heap* m_pHeap{};
 	};
-}
\ No newline at end of file
+}
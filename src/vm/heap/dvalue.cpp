@@ -10,8 +10,8 @@
 using namespace bloop::vm;
 using namespace std::string_literals;
 
-Object::Object(Function* function, UpValue** upVals, bloop::BloopUInt numVals) 
-	: type(Type::ot_closure), closure({ .function = function, .upvalues = upVals, .numValues= numVals }) {}
+Object::Object(Function* function, Object** upVals, bloop::BloopUInt numVals, Value* consts, bloop::BloopUInt numConsts) 
+	: type(Type::ot_closure), closure({ .function = function, .upvalues = upVals, .numValues= numVals, .constants = consts, .numConstants = numConsts }) {}
 
 Object::Object(bloop::BloopInt ucount) : type(Type::ot_array), array({ .values = new Value[ucount], .count = ucount }) {}
 
@@ -29,9 +29,10 @@ void Object::Free()
 		break;
 	case Type::ot_closure:
 		delete[] closure.upvalues;
+		delete[] closure.constants;
 		break;
 	case Type::ot_upvalue:
-		delete upvalue;
+		//inline
 		break;
 	default:
 		break;
@@ -48,9 +49,9 @@ std::size_t Object::GetSize() const
 	case Type::ot_function:
 		return sizeof(Object); //just a handle, has no allocated size
 	case Type::ot_closure:
-		return sizeof(Object) + (sizeof(closure.upvalues) * closure.numValues);
+		return sizeof(Object) + (sizeof(closure.upvalues) * closure.numValues) + (sizeof(Value) * closure.numConstants);
 	case Type::ot_upvalue:
-		return sizeof(Object) + sizeof(upvalue);
+		return sizeof(Object); //the cell is inline
 	default:
 		return sizeof(Object);
 	}
@@ -86,6 +87,8 @@ bloop::BloopString Object::TypeToString() const {
 		return BLOOPTEXT("function");
 	case VT::ot_closure:
 		return BLOOPTEXT("closure");
+	case VT::ot_upvalue:
+		return BLOOPTEXT("upvalue");
 	}
 
 	throw exception::VMError(BLOOPTEXT("type is not convertible to a string"));
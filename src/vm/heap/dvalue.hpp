@@ -1,18 +1,21 @@
 #pragma once
 
 #include "utils/defs.hpp"
+#include "vm/value.hpp"
 #include <unordered_set>
 
 namespace bloop::vm
 {
 	struct Function;
-	struct Value;
-	struct UpValue;
+	struct Chunk;
+	struct Object;
 
 	struct Closure {
 		Function* function;
-		UpValue** upvalues;
+		Object** upvalues; // ot_upvalue objects
 		bloop::BloopUInt numValues;
+		Value* constants; // const captures, copied when the closure was made
+		bloop::BloopUInt numConstants;
 	};
 
 	struct Object {
@@ -20,8 +23,8 @@ namespace bloop::vm
 
 		Object(char* _data, bloop::BloopInt _len) : type(Type::ot_string), string({.data=_data, .len=_len}) {}
 		Object(Function* chunk) : type(Type::ot_function), function(chunk){}
-		Object(Function* function, UpValue** upVals, bloop::BloopUInt numVals);
-		Object(UpValue* upval) : type(Type::ot_upvalue), upvalue(upval){}
+		Object(Function* function, Object** upVals, bloop::BloopUInt numVals, Value* consts, bloop::BloopUInt numConsts);
+		Object(Value* slot) : type(Type::ot_upvalue), upvalue({ .location = slot, .closed = {} }) {}
 
 		Object(bloop::BloopInt ucount);
 
@@ -36,13 +39,18 @@ namespace bloop::vm
 				bloop::BloopInt count;
 			}array;
 			Closure closure;
-			UpValue* upvalue;
+			UpValue upvalue;
 		};
 
 		//managed by GC
 		bool marked{};
 		Object* next{};
 
+		//where the object was allocated, resolved lazily for heap snapshots
+		//only recorded after VM::RecordAllocationSites
+		const Chunk* allocChunk{};
+		std::size_t allocIp{};
+
 		void Free();
 		[[nodiscard]] std::size_t GetSize() const;
 
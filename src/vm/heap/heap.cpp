@@ -13,6 +13,11 @@ Object* Heap::Allocate(Object* newObj) {
 	if (ShouldCollect())
 		m_pVM->m_oGC.Collect(m_pVM);
 
+	if (const auto frame = m_pVM->m_pCurrentFrame; frame && m_bRecordSites) {
+		newObj->allocChunk = frame->m_pChunk;
+		newObj->allocIp = frame->m_uIp;
+	}
+
 	newObj->next = m_pObjects;
 	m_pObjects = newObj;
 	m_uBytesAllocated += newObj->GetSize();
@@ -27,9 +32,6 @@ Object* Heap::AllocString(char* data, std::size_t len) {
 	std::memcpy(newBuf, data, len);
 	return Allocate(new Object(newBuf, len));
 }
-Object* Heap::AllocCallable(Function* callable) {
-	return Allocate(new Object(callable));
-}
 Object* Heap::AllocArray(std::size_t numValues) {
 
 	auto arr = Allocate(new Object(numValues));
@@ -39,15 +41,13 @@ Object* Heap::AllocArray(std::size_t numValues) {
 
 	return arr;
 }
-Object* Heap::AllocClosure(Function* function, bloop::BloopUInt numVals) {
-	auto vals = new UpValue*[numVals];
-	return Allocate(new Object(function, vals, numVals));
+Object* Heap::AllocClosure(Function* function, bloop::BloopUInt numVals, bloop::BloopUInt numConsts) {
+	auto vals = new Object*[numVals]{}; // the GC can run before every capture is filled
+	auto consts = numConsts ? new Value[numConsts] : nullptr;
+	return Allocate(new Object(function, vals, numVals, consts, numConsts));
 }
-Object* Heap::AllocUpValue(Value* slot, UpValue* location) {
-	auto up = new UpValue{ nullptr, slot, {}, location };
-	auto r = Allocate(new Object(up));
-	up->owner = r;
-	return r;
+Object* Heap::AllocUpValue(Value* slot) {
+	return Allocate(new Object(slot));
 }
 Object* Heap::StringConcat(Object* a, Object* b)
 {
@@ -8,7 +8,6 @@ namespace bloop::vm
 	struct Function;
 	struct Value;
 	struct Object;
-	struct UpValue;
 
 	class Heap {
 		friend class GC;
@@ -19,10 +18,9 @@ namespace bloop::vm
 		[[nodiscard]] Object* Allocate(Object* newObj);
 		[[nodiscard]] Object* AllocString(char* data, std::size_t len);
 		[[nodiscard]] Object* AllocString(std::size_t len);
-		[[nodiscard]] Object* AllocCallable(Function* callable);
 		[[nodiscard]] Object* AllocArray(std::size_t numValues);
-		[[nodiscard]] Object* AllocClosure(Function* function, bloop::BloopUInt numVals);
-		[[nodiscard]] Object* AllocUpValue(Value* slot, UpValue* location);
+		[[nodiscard]] Object* AllocClosure(Function* function, bloop::BloopUInt numVals, bloop::BloopUInt numConsts);
+		[[nodiscard]] Object* AllocUpValue(Value* slot);
 
 		[[nodiscard]] Object* StringConcat(Object* a, Object* b);
 
@@ -37,6 +35,7 @@ namespace bloop::vm
 		Object* m_pObjects{};
 		std::size_t m_uBytesAllocated{};
 		std::size_t m_uNextGCLimit{ 1024 * 1024 };
+		bool m_bRecordSites{}; // only the heap snapshots need the allocation sites
 		VM* m_pVM{};
 	};
 }
\ No newline at end of file
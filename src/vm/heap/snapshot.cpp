@@ -0,0 +1,304 @@
+#include "vm/heap/snapshot.hpp"
+#include "vm/exception.hpp"
+#include "utils/fmt.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <ranges>
+#include <unordered_map>
+
+using namespace bloop::vm;
+
+namespace {
+	constexpr char SNAPSHOT_MAGIC[4] = { 'B', 'L', 'H', 'S' };
+	constexpr std::uint32_t SNAPSHOT_VERSION = 1u;
+
+	// everything is stored as little endian so that snapshots can be moved between machines
+	template<typename T>
+	void WriteInt(std::ofstream& out, T value) {
+		char bytes[sizeof(T)];
+		for (const auto i : std::views::iota(0u, sizeof(T)))
+			bytes[i] = static_cast<char>((static_cast<std::uint64_t>(value) >> (i * 8u)) & 0xffu);
+		out.write(bytes, sizeof(T));
+	}
+	void WriteString(std::ofstream& out, const bloop::BloopString& str) {
+		WriteInt<std::uint32_t>(out, static_cast<std::uint32_t>(str.size()));
+		out.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+	template<typename T>
+	[[nodiscard]] T ReadInt(std::ifstream& in) {
+		unsigned char bytes[sizeof(T)]{};
+		if (!in.read(reinterpret_cast<char*>(bytes), sizeof(T)))
+			throw bloop::exception::VMError(BLOOPTEXT("unexpected end of the heap snapshot"));
+
+		std::uint64_t value{};
+		for (const auto i : std::views::iota(0u, sizeof(T)))
+			value |= static_cast<std::uint64_t>(bytes[i]) << (i * 8u);
+		return static_cast<T>(value);
+	}
+	[[nodiscard]] bloop::BloopString ReadString(std::ifstream& in) {
+		bloop::BloopString str(ReadInt<std::uint32_t>(in), BLOOPTEXT('\0'));
+		if (!in.read(str.data(), static_cast<std::streamsize>(str.size())))
+			throw bloop::exception::VMError(BLOOPTEXT("unexpected end of the heap snapshot"));
+		return str;
+	}
+}
+
+std::uint32_t HeapSnapshot::InternString(const bloop::BloopString& str) {
+	if (const auto it = std::ranges::find(m_oStrings, str); it != m_oStrings.end())
+		return static_cast<std::uint32_t>(std::distance(m_oStrings.begin(), it));
+
+	m_oStrings.push_back(str);
+	return static_cast<std::uint32_t>(m_oStrings.size() - 1u);
+}
+
+void HeapSnapshot::Write(const bloop::BloopString& path) const {
+	std::ofstream out(path, std::ios::binary);
+	if (!out)
+		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("couldn't open \"{}\" for writing"), path));
+
+	out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	WriteInt(out, SNAPSHOT_VERSION);
+
+	WriteInt<std::uint32_t>(out, static_cast<std::uint32_t>(m_oStrings.size()));
+	for (const auto& str : m_oStrings)
+		WriteString(out, str);
+
+	WriteInt<std::uint32_t>(out, static_cast<std::uint32_t>(m_oSites.size()));
+	for (const auto& site : m_oSites) {
+		WriteString(out, site.m_sFunction);
+		WriteInt<std::uint64_t>(out, site.m_uLine);
+		WriteInt<std::uint64_t>(out, site.m_uColumn);
+	}
+
+	WriteInt<std::uint32_t>(out, static_cast<std::uint32_t>(m_oNodes.size()));
+	for (const auto& node : m_oNodes) {
+		WriteInt(out, node.m_uAddress);
+		WriteInt(out, node.m_uType);
+		WriteInt(out, node.m_uSite);
+		WriteInt(out, node.m_uSize);
+	}
+
+	WriteInt<std::uint32_t>(out, static_cast<std::uint32_t>(m_oEdges.size()));
+	for (const auto& edge : m_oEdges) {
+		WriteInt(out, edge.m_uFrom);
+		WriteInt(out, edge.m_uTo);
+		WriteInt(out, static_cast<bloop::BloopByte>(edge.m_eKind));
+		WriteInt(out, edge.m_uIndex);
+	}
+
+	if (!out)
+		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("couldn't write the heap snapshot to \"{}\""), path));
+}
+
+HeapSnapshot HeapSnapshot::Read(const bloop::BloopString& path) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("couldn't open \"{}\" for reading"), path));
+
+	char magic[sizeof(SNAPSHOT_MAGIC)]{};
+	if (!in.read(magic, sizeof(magic)) || !std::ranges::equal(magic, SNAPSHOT_MAGIC))
+		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("\"{}\" is not a heap snapshot"), path));
+
+	if (const auto version = ReadInt<std::uint32_t>(in); version != SNAPSHOT_VERSION)
+		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("unsupported heap snapshot version {}"), version));
+
+	HeapSnapshot snapshot;
+
+	snapshot.m_oStrings.resize(ReadInt<std::uint32_t>(in));
+	for (auto& str : snapshot.m_oStrings)
+		str = ReadString(in);
+
+	snapshot.m_oSites.resize(ReadInt<std::uint32_t>(in));
+	for (auto& site : snapshot.m_oSites) {
+		site.m_sFunction = ReadString(in);
+		site.m_uLine = static_cast<std::size_t>(ReadInt<std::uint64_t>(in));
+		site.m_uColumn = static_cast<std::size_t>(ReadInt<std::uint64_t>(in));
+	}
+
+	snapshot.m_oNodes.resize(ReadInt<std::uint32_t>(in));
+	for (auto& node : snapshot.m_oNodes) {
+		node.m_uAddress = ReadInt<std::uint64_t>(in);
+		node.m_uType = ReadInt<std::uint32_t>(in);
+		node.m_uSite = ReadInt<std::uint32_t>(in);
+		node.m_uSize = ReadInt<std::uint64_t>(in);
+
+		if (node.m_uType >= snapshot.m_oStrings.size() || (node.m_uSite != NO_SITE && node.m_uSite >= snapshot.m_oSites.size()))
+			throw exception::VMError(BLOOPTEXT("corrupted heap snapshot node"));
+	}
+
+	snapshot.m_oEdges.resize(ReadInt<std::uint32_t>(in));
+	for (auto& edge : snapshot.m_oEdges) {
+		edge.m_uFrom = ReadInt<std::uint32_t>(in);
+		edge.m_uTo = ReadInt<std::uint32_t>(in);
+		edge.m_eKind = static_cast<EdgeKind>(ReadInt<bloop::BloopByte>(in));
+		edge.m_uIndex = ReadInt<std::uint32_t>(in);
+
+		if (edge.m_uFrom >= snapshot.m_oNodes.size() || edge.m_uTo >= snapshot.m_oNodes.size())
+			throw exception::VMError(BLOOPTEXT("corrupted heap snapshot edge"));
+	}
+
+	if (snapshot.m_oNodes.empty())
+		throw exception::VMError(BLOOPTEXT("the heap snapshot has no root node"));
+
+	return snapshot;
+}
+
+bloop::BloopString HeapSnapshot::SiteToString(std::uint32_t site) const {
+	if (site == NO_SITE)
+		return BLOOPTEXT("<vm>");
+
+	const auto& s = m_oSites[site];
+	return bloop::fmt::format(BLOOPTEXT("{} [{}, {}]"), s.m_sFunction, s.m_uLine, s.m_uColumn);
+}
+bloop::BloopString HeapSnapshot::EdgeKindToString(EdgeKind kind) {
+	switch (kind) {
+	case EdgeKind::ek_global:
+		return BLOOPTEXT("global");
+	case EdgeKind::ek_stack:
+		return BLOOPTEXT("stack");
+	case EdgeKind::ek_constant:
+		return BLOOPTEXT("constant");
+	case EdgeKind::ek_open_upvalue:
+		return BLOOPTEXT("open upvalue");
+	case EdgeKind::ek_element:
+		return BLOOPTEXT("element");
+	case EdgeKind::ek_upvalue:
+		return BLOOPTEXT("upvalue");
+	case EdgeKind::ek_value:
+		return BLOOPTEXT("value");
+	case EdgeKind::ek_captured_const:
+		return BLOOPTEXT("captured const");
+	case EdgeKind::ek_memo:
+		return BLOOPTEXT("memo");
+	}
+	return BLOOPTEXT("unknown");
+}
+
+HeapSummary HeapSummary::Compute(const HeapSnapshot& snapshot) {
+	constexpr auto UNDEFINED = std::numeric_limits<std::uint32_t>::max();
+	const auto numNodes = snapshot.m_oNodes.size();
+
+	std::vector<std::vector<std::uint32_t>> successors(numNodes);
+	std::vector<std::vector<std::uint32_t>> predecessors(numNodes);
+	for (const auto& edge : snapshot.m_oEdges) {
+		successors[edge.m_uFrom].push_back(edge.m_uTo);
+		predecessors[edge.m_uTo].push_back(edge.m_uFrom);
+	}
+
+	// reverse postorder from the root
+	std::vector<std::uint32_t> order;
+	std::vector<std::uint32_t> orderIndex(numNodes, UNDEFINED);
+	{
+		std::vector<bool> visited(numNodes);
+		std::vector<std::pair<std::uint32_t, std::size_t>> stack{ { HeapSnapshot::ROOT_NODE, 0u } };
+		visited[HeapSnapshot::ROOT_NODE] = true;
+
+		while (!stack.empty()) {
+			auto& [node, next] = stack.back();
+			if (next < successors[node].size()) {
+				const auto succ = successors[node][next++];
+				if (!visited[succ]) {
+					visited[succ] = true;
+					stack.emplace_back(succ, 0u);
+				}
+				continue;
+			}
+			order.push_back(node);
+			stack.pop_back();
+		}
+		std::ranges::reverse(order);
+		for (const auto i : std::views::iota(0u, order.size()))
+			orderIndex[order[i]] = static_cast<std::uint32_t>(i);
+	}
+
+	// Cooper, Harvey & Kennedy: "A Simple, Fast Dominance Algorithm"
+	std::vector<std::uint32_t> idom(numNodes, UNDEFINED);
+	idom[HeapSnapshot::ROOT_NODE] = HeapSnapshot::ROOT_NODE;
+
+	const auto Intersect = [&](std::uint32_t a, std::uint32_t b) {
+		while (a != b) {
+			while (orderIndex[a] > orderIndex[b])
+				a = idom[a];
+			while (orderIndex[b] > orderIndex[a])
+				b = idom[b];
+		}
+		return a;
+	};
+
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (const auto node : order | std::views::drop(1)) {
+			auto newIdom = UNDEFINED;
+			for (const auto pred : predecessors[node]) {
+				if (idom[pred] == UNDEFINED)
+					continue;
+				newIdom = newIdom == UNDEFINED ? pred : Intersect(pred, newIdom);
+			}
+			if (newIdom != idom[node]) {
+				idom[node] = newIdom;
+				changed = true;
+			}
+		}
+	}
+
+	std::vector<std::uint64_t> retained(numNodes);
+	for (const auto node : order)
+		retained[node] = snapshot.m_oNodes[node].m_uSize;
+	for (const auto node : order | std::views::drop(1) | std::views::reverse)
+		retained[idom[node]] += retained[node];
+
+	std::vector<std::vector<std::uint32_t>> children(numNodes);
+	for (const auto node : order | std::views::drop(1))
+		children[idom[node]].push_back(node);
+
+	HeapSummary summary;
+
+	// an object only adds to its group's retained size when no dominator of it belongs to the same group
+	std::unordered_map<bloop::BloopString, std::size_t> activeTypes;
+	std::unordered_map<bloop::BloopString, std::size_t> activeSites;
+	std::vector<std::pair<std::uint32_t, bool>> stack{ { HeapSnapshot::ROOT_NODE, false } };
+
+	while (!stack.empty()) {
+		const auto [node, leaving] = stack.back();
+		stack.pop_back();
+
+		if (node == HeapSnapshot::ROOT_NODE) {
+			for (const auto child : children[node])
+				stack.emplace_back(child, false);
+			continue;
+		}
+
+		const auto& n = snapshot.m_oNodes[node];
+		const auto& type = snapshot.m_oStrings[n.m_uType];
+		const auto site = snapshot.SiteToString(n.m_uSite);
+
+		if (leaving) {
+			activeTypes[type]--;
+			activeSites[site]--;
+			continue;
+		}
+
+		auto& byType = summary.m_oByType[type];
+		auto& bySite = summary.m_oBySite[site];
+		byType.m_uCount++;
+		bySite.m_uCount++;
+		byType.m_uShallowSize += n.m_uSize;
+		bySite.m_uShallowSize += n.m_uSize;
+
+		if (activeTypes[type]++ == 0u)
+			byType.m_uRetainedSize += retained[node];
+		if (activeSites[site]++ == 0u)
+			bySite.m_uRetainedSize += retained[node];
+
+		summary.m_uNumObjects++;
+		summary.m_uTotalSize += n.m_uSize;
+
+		stack.emplace_back(node, true);
+		for (const auto child : children[node])
+			stack.emplace_back(child, false);
+	}
+
+	return summary;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "utils/defs.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace bloop::vm
+{
+	// a plain copy of the object graph at the time of the snapshot
+	// doesn't reference the VM, so it can be written, read and analyzed anywhere
+	struct HeapSnapshot {
+		static constexpr std::uint32_t ROOT_NODE = 0u; // synthetic node that owns all root edges
+		static constexpr std::uint32_t NO_SITE = std::numeric_limits<std::uint32_t>::max();
+
+		enum class EdgeKind : bloop::BloopByte {
+			ek_global,
+			ek_stack,
+			ek_constant,
+			ek_open_upvalue,
+			ek_element,
+			ek_upvalue,
+			ek_value,
+			ek_captured_const,
+			ek_memo
+		};
+
+		struct Site {
+			bloop::BloopString m_sFunction;
+			std::size_t m_uLine{};
+			std::size_t m_uColumn{};
+		};
+		struct Node {
+			std::uint64_t m_uAddress{};
+			std::uint32_t m_uType{}; // index to m_oStrings
+			std::uint32_t m_uSite{ NO_SITE }; // index to m_oSites
+			std::uint64_t m_uSize{};
+		};
+		struct Edge {
+			std::uint32_t m_uFrom{};
+			std::uint32_t m_uTo{};
+			EdgeKind m_eKind{};
+			std::uint32_t m_uIndex{}; // slot, element or upvalue index depending on the kind
+		};
+
+		[[nodiscard]] std::uint32_t InternString(const bloop::BloopString& str);
+
+		void Write(const bloop::BloopString& path) const;
+		[[nodiscard]] static HeapSnapshot Read(const bloop::BloopString& path);
+
+		[[nodiscard]] bloop::BloopString SiteToString(std::uint32_t site) const;
+		[[nodiscard]] static bloop::BloopString EdgeKindToString(EdgeKind kind);
+
+		std::vector<bloop::BloopString> m_oStrings;
+		std::vector<Site> m_oSites;
+		std::vector<Node> m_oNodes;
+		std::vector<Edge> m_oEdges;
+	};
+
+	struct HeapSummary {
+		struct Entry {
+			std::size_t m_uCount{};
+			std::uint64_t m_uShallowSize{};
+			std::uint64_t m_uRetainedSize{}; // objects of the same group aren't counted twice
+		};
+
+		// computes retained sizes from the dominator tree of the snapshot
+		[[nodiscard]] static HeapSummary Compute(const HeapSnapshot& snapshot);
+
+		std::size_t m_uNumObjects{};
+		std::uint64_t m_uTotalSize{};
+		std::map<bloop::BloopString, Entry> m_oByType;
+		std::map<bloop::BloopString, Entry> m_oBySite;
+	};
+}
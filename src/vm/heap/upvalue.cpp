@@ -4,29 +4,27 @@
 
 using namespace bloop::vm;
 
-UpValue* VM::CaptureUpValue(Value* slot) {
+Object* VM::CaptureUpValue(std::size_t slot) {
 
-	UpValue* prev = nullptr;
-	UpValue* curr = m_pOpenUpValues;
+    if (slot >= m_oOpenUpValues.size())
+        m_oOpenUpValues.resize(slot + 1u);
 
-    while (curr && curr->location > slot) {
-        prev = curr;
-        curr = curr->next;
-    }
-
-    if (curr && curr->location == slot)
-        return curr;
+    if (const auto open = m_oOpenUpValues[slot])
+        return open;
 
-    auto up = m_oHeap.AllocUpValue(slot, curr);
-    if (prev) prev->next = up->upvalue;
-    else m_pOpenUpValues = up->upvalue;
-    return up->upvalue;
+    auto up = m_oHeap.AllocUpValue(&m_oStack[slot]);
+    m_oOpenUpValues[slot] = up;
+    m_oOpenSlots.push_back(slot);
+    return up;
 }
-void VM::CloseUpValues(Value* lastSlot)
+void VM::CloseUpValues(std::size_t firstSlot)
 {
-    while (m_pOpenUpValues && m_pOpenUpValues->location >= lastSlot) {
-        m_pOpenUpValues->closed = *m_pOpenUpValues->location;
-        m_pOpenUpValues->location = &m_pOpenUpValues->closed;
-        m_pOpenUpValues = m_pOpenUpValues->next;
+    while (!m_oOpenSlots.empty() && m_oOpenSlots.back() >= firstSlot) {
+        auto& up = m_oOpenUpValues[m_oOpenSlots.back()]->upvalue;
+        up.closed = *up.location;
+        up.location = &up.closed;
+
+        m_oOpenUpValues[m_oOpenSlots.back()] = nullptr;
+        m_oOpenSlots.pop_back();
     }
-}
\ No newline at end of file
+}
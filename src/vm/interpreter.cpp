@@ -29,7 +29,22 @@ VM::ExecutionReturnCode VM::InterpretOpCode(TOpCode op) {
 			break;
 		} case TOpCode::LOAD_UPVALUE: {
 			const auto idx = FetchOperand();
-			Push(*m_pCurrentFrame->m_pClosure->upvalues[idx]->location);
+			Push(*m_pCurrentFrame->m_pClosure->upvalues[idx]->upvalue.location);
+			break;
+		} case TOpCode::LOAD_CAPTURED_CONST: {
+			const auto idx = FetchOperand();
+			assert(idx < m_pCurrentFrame->m_pClosure->numConstants);
+			Push(m_pCurrentFrame->m_pClosure->constants[idx]);
+			break;
+		} case TOpCode::LOAD_ENCLOSING: {
+			const auto idx = m_pCurrentFrame->m_uEnclosingBase + FetchOperand();
+			assert(idx < m_oStack.size());
+			Push(m_oStack[idx]);
+			break;
+		} case TOpCode::STORE_ENCLOSING: {
+			const auto idx = m_pCurrentFrame->m_uEnclosingBase + FetchOperand();
+			assert(idx < m_oStack.size());
+			m_oStack[idx] = Pop();
 			break;
 		} case TOpCode::CREATE_ARRAY: {
 			const auto numInitializers = FetchOperand();
@@ -53,12 +68,15 @@ VM::ExecutionReturnCode VM::InterpretOpCode(TOpCode op) {
 		} case TOpCode::STORE_UPVALUE: {
 			const auto idx = FetchOperand();
 			assert(idx <= static_cast<bloop::BloopIndex>(m_pCurrentFrame->m_pClosure->numValues));
-			m_pCurrentFrame->m_pClosure->upvalues[idx]->closed = Pop();
+			*m_pCurrentFrame->m_pClosure->upvalues[idx]->upvalue.location = Pop();
+			break;
+		} case TOpCode::POP: {
+			[[maybe_unused]] const auto _ = Pop();
 			break;
 		} case TOpCode::MAKE_FUNCTION: {
 			const auto idx = FetchOperand();
-			assert(idx <= static_cast<bloop::BloopIndex>(m_oFunctions.size()));
-			Push(m_oHeap.AllocCallable(&m_oFunctions.at(idx)));
+			assert(idx < static_cast<bloop::BloopIndex>(m_oFunctionObjects.size()));
+			Push(&m_oFunctionObjects[idx]);
 			break;
 		} case TOpCode::ADD: {
 			Value b = Pop();
@@ -90,14 +108,65 @@ VM::ExecutionReturnCode VM::InterpretOpCode(TOpCode op) {
 			Value a = Pop();
 			Push(a <= b);
 			break;
+		} case TOpCode::ADD_INT: {
+			// the optimizer proved that both operands have this type
+			const Value b = Pop();
+			m_oStack.back().i += b.i;
+			break;
+		} case TOpCode::SUB_INT: {
+			const Value b = Pop();
+			m_oStack.back().i -= b.i;
+			break;
+		} case TOpCode::MUL_INT: {
+			const Value b = Pop();
+			m_oStack.back().i *= b.i;
+			break;
+		} case TOpCode::DIV_INT: {
+			const Value b = Pop();
+			if (b.i == 0)
+				throw exception::VMError(BLOOPTEXT("division by 0"));
+			m_oStack.back().i /= b.i;
+			break;
+		} case TOpCode::LESS_EQUAL_INT: {
+			const Value b = Pop();
+			auto& a = m_oStack.back();
+			a = a.i <= b.i;
+			break;
+		} case TOpCode::ADD_DOUBLE: {
+			const Value b = Pop();
+			m_oStack.back().d += b.d;
+			break;
+		} case TOpCode::SUB_DOUBLE: {
+			const Value b = Pop();
+			m_oStack.back().d -= b.d;
+			break;
+		} case TOpCode::MUL_DOUBLE: {
+			const Value b = Pop();
+			m_oStack.back().d *= b.d;
+			break;
+		} case TOpCode::DIV_DOUBLE: {
+			const Value b = Pop();
+			m_oStack.back().d /= b.d;
+			break;
+		} case TOpCode::LESS_EQUAL_DOUBLE: {
+			const Value b = Pop();
+			auto& a = m_oStack.back();
+			a = a.d <= b.d;
+			break;
 		} case TOpCode::JZ: {
 			const auto target = FetchOperand();
 			const Value v = Pop();
-			if (!v.IsTruthy())
+			if (!v.IsTruthy()) {
+				if (target < m_pCurrentFrame->m_uIp)
+					ConsumeFuel();
 				m_pCurrentFrame->m_uIp = target; // skip to the end of the loop
+			}
 			break;
 		} case TOpCode::JMP: {
-			m_pCurrentFrame->m_uIp = FetchOperand();
+			const auto target = FetchOperand();
+			if (target < m_pCurrentFrame->m_uIp)
+				ConsumeFuel(); // jumping back to the beginning of a loop
+			m_pCurrentFrame->m_uIp = target;
 			break;
 		} case TOpCode::CALL: {
 			const auto argc = FetchOperand();
@@ -120,6 +189,18 @@ VM::ExecutionReturnCode VM::InterpretOpCode(TOpCode op) {
 				RunClosure(&callee.obj->closure);
 			}
 			break;
+		} case TOpCode::CALL_DIRECT: {
+			// arity was checked at compile time
+			const auto idx = FetchOperand();
+			assert(idx < static_cast<bloop::BloopIndex>(m_oFunctions.size()));
+			RunFunction(&m_oFunctions[idx]);
+			break;
+		} case TOpCode::CALL_ENCLOSED: {
+			// arity was checked at compile time
+			const auto idx = FetchOperand();
+			assert(idx < static_cast<bloop::BloopIndex>(m_oFunctions.size()));
+			RunEnclosedFunction(&m_oFunctions[idx]);
+			break;
 		} case TOpCode::SUBSCRIPT_GET: {
 			Value index = Pop();
 			Value operand = Pop();
@@ -140,6 +221,19 @@ VM::ExecutionReturnCode VM::InterpretOpCode(TOpCode op) {
 			operand.obj->Index(index.ToInt()) = value;
 			Push(value);
 			break;
+		} case TOpCode::SUBSCRIPT_GET_UNCHECKED: {
+			// the optimizer proved that this is an array and that the index is in range
+			const Value index = Pop();
+			auto& operand = m_oStack.back();
+			assert(operand.IsIndexable() && index.i >= 0 && index.i < operand.obj->array.count);
+			operand = operand.obj->array.values[index.i];
+			break;
+		} case TOpCode::SUBSCRIPT_SET_UNCHECKED: {
+			const Value index = Pop();
+			const Value operand = Pop();
+			assert(operand.IsIndexable() && index.i >= 0 && index.i < operand.obj->array.count);
+			operand.obj->array.values[index.i] = m_oStack.back();
+			break;
 		} case TOpCode::RETURN: {
 			return ExecutionReturnCode::rc_return;
 		} case TOpCode::RETURN_VALUE: {
@@ -149,18 +243,38 @@ VM::ExecutionReturnCode VM::InterpretOpCode(TOpCode op) {
 			assert(funcIdx < static_cast<bloop::BloopIndex>(m_oFunctions.size()));
 			auto& func = m_oFunctions[funcIdx];
 
-			auto obj = m_oHeap.AllocClosure(&func, func.m_oCaptures.size());
+			auto obj = m_oHeap.AllocClosure(&func, func.m_oCaptures.size() - func.m_uNumCapturedConsts, func.m_uNumCapturedConsts);
+			auto& closure = obj->closure;
+			Push(obj); // capturing can allocate, so keep the closure reachable
 
-			for (const auto i : std::views::iota(0u, obj->closure.numValues)) {
+			for (bloop::BloopUInt numValues{}, numConstants{}; numValues + numConstants < func.m_oCaptures.size();) {
 				const auto opcode = static_cast<TOpCode>(m_pCurrentFrame->m_pChunk->m_oByteCode[m_pCurrentFrame->m_uIp++]);
 				const auto slot = FetchOperand();
 
-				if (opcode == TOpCode::CAPTURE_LOCAL)
-					obj->closure.upvalues[i] = CaptureUpValue(&m_oStack[m_pCurrentFrame->m_uBase + slot]);
-				else
-					obj->closure.upvalues[i] = m_pCurrentFrame->m_pClosure->upvalues[slot];
+				switch (opcode) {
+				case TOpCode::CAPTURE_LOCAL:
+					closure.upvalues[numValues++] = CaptureUpValue(m_pCurrentFrame->m_uBase + slot);
+					break;
+				case TOpCode::CAPTURE_UPVALUE:
+					closure.upvalues[numValues++] = m_pCurrentFrame->m_pClosure->upvalues[slot];
+					break;
+				case TOpCode::CAPTURE_CONST_LOCAL:
+					closure.constants[numConstants++] = m_oStack[m_pCurrentFrame->m_uBase + slot];
+					break;
+				case TOpCode::CAPTURE_CONST_UPVALUE:
+					closure.constants[numConstants++] = m_pCurrentFrame->m_pClosure->constants[slot];
+					break;
+				default:
+					assert(false);
+					break;
+				}
 			}
-			Push(obj);
+			break;
+		} case TOpCode::CAPTURE_LOCAL:
+		case TOpCode::CAPTURE_UPVALUE:
+		case TOpCode::CAPTURE_CONST_LOCAL:
+		case TOpCode::CAPTURE_CONST_UPVALUE: {
+			assert(false); // MAKE_CLOSURE reads these
 			break;
 		}
 	}
@@ -0,0 +1,90 @@
+#include "vm/memo.hpp"
+
+#include <algorithm>
+#include <functional>
+
+using namespace bloop::vm;
+
+std::size_t MemoCache::Hash(std::span<const Value> args) noexcept {
+
+	std::size_t seed = args.size();
+	for (const auto& v : args) {
+		std::size_t h{};
+		switch (v.type) {
+		case Value::Type::t_undefined:
+			break;
+		case Value::Type::t_bool:
+			h = std::hash<bloop::BloopBool>{}(v.b);
+			break;
+		case Value::Type::t_uint:
+			h = std::hash<bloop::BloopUInt>{}(v.u);
+			break;
+		case Value::Type::t_int:
+			h = std::hash<bloop::BloopInt>{}(v.i);
+			break;
+		case Value::Type::t_double:
+			h = std::hash<bloop::BloopDouble>{}(v.d);
+			break;
+		case Value::Type::t_object:
+			h = std::hash<const Object*>{}(v.obj);
+			break;
+		}
+
+		h ^= static_cast<std::size_t>(v.type) << 1u;
+		seed ^= h + 0x9e3779b9u + (seed << 6u) + (seed >> 2u);
+	}
+	return seed;
+}
+bool MemoCache::Equals(const Value& a, const Value& b) noexcept {
+
+	if (a.type != b.type)
+		return false;
+
+	switch (a.type) {
+	case Value::Type::t_undefined:
+		return true;
+	case Value::Type::t_bool:
+		return a.b == b.b;
+	case Value::Type::t_uint:
+		return a.u == b.u;
+	case Value::Type::t_int:
+		return a.i == b.i;
+	case Value::Type::t_double:
+		return a.d == b.d;
+	case Value::Type::t_object:
+		return a.obj == b.obj;
+	}
+	return false;
+}
+
+const Value* MemoCache::Find(std::span<const Value> args) {
+
+	const auto [first, last] = m_oIndex.equal_range(Hash(args));
+
+	for (auto it = first; it != last; ++it) {
+		const auto entry = it->second;
+		if (!std::ranges::equal(entry->m_oArgs, args, Equals))
+			continue;
+
+		m_oEntries.splice(m_oEntries.begin(), m_oEntries, entry);
+		return &entry->m_oResult;
+	}
+	return nullptr;
+}
+void MemoCache::Insert(std::span<const Value> args, const Value& result) {
+
+	if (m_oEntries.size() >= BLOOP_MEMO_CAPACITY) {
+		const auto oldest = std::prev(m_oEntries.end());
+		const auto [first, last] = m_oIndex.equal_range(oldest->m_uHash);
+		m_oIndex.erase(std::ranges::find(first, last, oldest, [](const auto& pair) { return pair.second; }));
+		m_oEntries.erase(oldest);
+	}
+
+	const auto hash = Hash(args);
+	m_oEntries.push_front({ .m_uHash = hash, .m_oArgs = { args.begin(), args.end() }, .m_oResult = result });
+	m_oIndex.emplace(hash, m_oEntries.begin());
+}
+void MemoCache::Clear() noexcept {
+	m_oIndex.clear();
+	m_oEntries.clear();
+}
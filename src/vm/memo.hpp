@@ -0,0 +1,49 @@
+#pragma once
+
+#include "utils/defs.hpp"
+#include "vm/value.hpp"
+
+#include <list>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace bloop::vm
+{
+	// results of a memo function, keyed by the arguments of the call
+	// primitives are compared by value and objects by identity
+	// an object result isn't copied, every hit returns the same object that the first call created
+	// so changing e.g. a returned array also changes what the later calls with the same arguments get
+	// holds at most BLOOP_MEMO_CAPACITY entries, the least recently used one is dropped first
+	class MemoCache {
+	public:
+		// nullptr when the arguments haven't been seen, a hit becomes the most recently used entry
+		[[nodiscard]] const Value* Find(std::span<const Value> args);
+		void Insert(std::span<const Value> args, const Value& result);
+		void Clear() noexcept;
+
+		// the gc treats every key and result as a root, callback(const Value&)
+		template<typename Callback>
+		void ForEachValue(Callback&& callback) const {
+			for (const auto& entry : m_oEntries) {
+				for (const auto& arg : entry.m_oArgs)
+					callback(arg);
+				callback(entry.m_oResult);
+			}
+		}
+
+	private:
+		struct Entry {
+			std::size_t m_uHash{};
+			std::vector<Value> m_oArgs;
+			Value m_oResult;
+		};
+		using EntryList = std::list<Entry>;
+
+		[[nodiscard]] static std::size_t Hash(std::span<const Value> args) noexcept;
+		[[nodiscard]] static bool Equals(const Value& a, const Value& b) noexcept;
+
+		EntryList m_oEntries; // the most recently used first
+		std::unordered_multimap<std::size_t, EntryList::iterator> m_oIndex; // by hash, so a lookup doesn't copy the arguments
+	};
+}
@@ -45,11 +45,10 @@ namespace bloop::vm {
     };
 
 
+    // lives inline in its heap object
     struct UpValue {
-        Object* owner{};
-        Value* location{}; //stack slot or &closed
+        Value* location; //stack slot or &closed
         Value closed; //when stack slot goes out of scope
-        UpValue* next{};
     };
 
 }
\ No newline at end of file
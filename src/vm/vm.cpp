@@ -20,6 +20,13 @@ std::vector<Value> VM::BuildConstants(const std::vector<bloop::bytecode::CConsta
 	}
 	return vals;
 }
+std::vector<Value> VM::GetConstants(const std::vector<bloop::bytecode::ConstantId>& ids) const {
+	std::vector<Value> vals;
+	vals.reserve(ids.size());
+	for (const auto id : ids)
+		vals.push_back(m_oConstants[id]);
+	return vals;
+}
 
 [[nodiscard]] static auto ConvertPositions(const std::vector<bloop::bytecode::CInstructionPosition>& v) {
 	std::vector<CInstructionPosition> ret;
@@ -32,45 +39,62 @@ std::vector<Value> VM::BuildConstants(const std::vector<bloop::bytecode::CConsta
 	std::vector<Capture> ret;
 	ret.reserve(v.size());
 	for (auto& var : v)
-		ret.push_back(Capture{ .m_uSlot = var.m_uSlot, .m_bIsLocal = var.m_bIsLocal });
+		ret.push_back(Capture{ .m_uSlot = var.m_uSlot, .m_bIsLocal = var.m_bIsLocal, .m_bByValue = var.m_bByValue });
 	return ret;
 }
 VM::VM(const bloop::bytecode::VMByteCode& data)
 	: m_oHeap(this), m_oGC(&m_oHeap) {
 
-	m_oGlobalChunk.m_oConstants = BuildConstants(data.chunk.m_oConstants);
+	m_oConstants = BuildConstants(data.constants);
+
+	m_oGlobalChunk.m_oConstants = GetConstants(data.chunk.m_oConstantIds);
 	m_oGlobalChunk.m_oByteCode = data.chunk.m_oByteCode;
+	m_oGlobalChunk.m_oPositions = ConvertPositions(data.chunk.m_oPositions);
 	m_oGlobals.resize(data.numGlobals);
 
 	for (const auto& f : data.functions) {
 		m_oFunctions.emplace_back(Function{
+			.m_sName = f.m_sName,
 			.chunk = {
-				.m_oConstants = BuildConstants(f.chunk.m_oConstants),
+				.m_oConstants = GetConstants(f.chunk.m_oConstantIds),
 				.m_oByteCode = f.chunk.m_oByteCode,
 				.m_oPositions = ConvertPositions(f.chunk.m_oPositions)
 			},
 			.m_uParamCount = f.m_uParamCount,
 			.m_uLocalCount = f.m_uLocalCount,
-			.m_oCaptures = ConvertCaptures(f.m_oCaptures)
+			.m_oCaptures = ConvertCaptures(f.m_oCaptures),
+			.m_uNumCapturedConsts = static_cast<bloop::BloopUInt>(std::ranges::count_if(f.m_oCaptures, 
+				[](const bloop::bytecode::vmdata::Capture& c) { return c.m_bByValue; })),
+			.m_oMemo = f.m_bMemoize ? std::optional<MemoCache>(std::in_place) : std::nullopt
 		});
 	}
 
 	for (auto idx = std::size_t{ 0 }; auto& f : m_oFunctions)
 		m_oFunctionTable[data.functions[idx++].m_sName ] = &f;
 
+	// a function without captures is just a handle, so every MAKE_FUNCTION can share the same one
+	m_oFunctionObjects.reserve(m_oFunctions.size());
+	for (auto& f : m_oFunctions)
+		m_oFunctionObjects.emplace_back(&f).marked = true; // the GC skips marked objects
+
 	m_oStack.reserve(BLOOP_MAX_STACK);
 	m_oFrames.reserve(BLOOP_MAX_FRAMES);
 }
 VM::~VM() {
 	
-	// if the user never called "Run", then nothing needs to be cleared
-	if (!m_oStack.empty()) {
-		//assert(m_oStack.size() == 1); //something leaked if not true
-		m_oStack.clear(); //free everything for the GC
-		m_oGlobals.clear(); // let the gc get rid of these
-		m_oGC.Collect(this); //clear everything
-
+	//assert(m_oStack.size() == 1); //something leaked if not true
+	m_oStack.clear(); //free everything for the GC
+	m_oGlobals.clear(); // let the gc get rid of these
+	m_oConstants.clear(); // constants are roots too, even if "Run" was never called
+	m_oGlobalChunk.m_oConstants.clear();
+	for (auto& f : m_oFunctions) {
+		f.chunk.m_oConstants.clear();
+		if (f.m_oMemo)
+			f.m_oMemo->Clear();
 	}
+	m_oOpenSlots.clear();
+	m_oMemoArgs.clear();
+	m_oGC.Collect(this); //clear everything
 
 	assert(m_oHeap.GetAllocatedSize() == 0u);
 }
@@ -117,6 +141,38 @@ void VM::Run(const bloop::BloopString& entryFuncName) {
 
 	std::cout << bloop::fmt::format("\nreturned: {} : {}\n", m_oStack.front().ValueToString(), m_oStack.front().TypeToString());
 }
+void VM::WriteHeapSnapshot(const bloop::BloopString& path) {
+	m_oGC.Snapshot(this).Write(path);
+}
+Value VM::Call(bloop::BloopIndex functionId, const std::vector<bloop::bytecode::CConstant>& args, bloop::BloopUInt fuel) {
+	assert(functionId < static_cast<bloop::BloopIndex>(m_oFunctions.size()));
+	auto& func = m_oFunctions[functionId];
+
+	if (func.m_uParamCount != args.size())
+		throw exception::VMError(bloop::fmt::format(BLOOPTEXT("passed {} arguments, but expected {}"), args.size(), func.m_uParamCount));
+
+	m_uFuel = fuel;
+
+	try {
+		// one by one, so the gc can see the strings that were already allocated
+		for (const auto& arg : args)
+			Push(BuildConstants({ arg }).front());
+
+		RunFunction(&func);
+	} catch (exception::VMError&) {
+		// leave the vm usable for the next call
+		CloseUpValues(0u);
+		m_oStack.clear();
+		m_oMemoArgs.clear();
+		m_oFrames.clear();
+		m_pCurrentFrame = nullptr;
+		m_uFuel = 0u;
+		throw;
+	}
+
+	m_uFuel = 0u;
+	return Pop();
+}
 VM::ExecutionReturnCode VM::RunFrame() {
 	auto& bytecode = m_pCurrentFrame->m_pChunk->m_oByteCode;
 	ExecutionReturnCode returnCode{};
@@ -138,9 +194,44 @@ void VM::RunGlobal() {
 	m_pCurrentFrame = nullptr;
 }
 void VM::RunFunction(Function* fn) {
+	if (fn->m_oMemo)
+		return RunMemoFunction(fn);
+
+	RunFunctionBody(fn);
+}
+void VM::RunMemoFunction(Function* fn) {
+	auto& memo = *fn->m_oMemo;
+	const auto firstArg = m_oStack.size() - fn->m_uParamCount;
+
+	if (const auto cached = memo.Find(std::span(m_oStack).subspan(firstArg))) {
+		const Value result = *cached;
+		m_oStack.resize(firstArg);
+		Push(result);
+		return;
+	}
+
+	const auto key = m_oMemoArgs.size();
+	m_oMemoArgs.insert(m_oMemoArgs.end(), m_oStack.begin() + static_cast<std::ptrdiff_t>(firstArg), m_oStack.end());
+
+	RunFunctionBody(fn);
+
+	memo.Insert(std::span(m_oMemoArgs).subspan(key), m_oStack.back());
+	m_oMemoArgs.resize(key);
+}
+void VM::RunFunctionBody(Function* fn) {
+	PushFrame(fn);
+	const auto returnCode = RunFrame();
+	CloseUpValues(m_pCurrentFrame->m_uBase);
+	const Value ret = returnCode == ExecutionReturnCode::rc_return_value ? Pop() : Value();
+	PopFrame();
+	Push(ret);
+}
+void VM::RunEnclosedFunction(Function* fn) {
+	const auto enclosingBase = m_pCurrentFrame->m_uBase;
 	PushFrame(fn);
+	m_pCurrentFrame->m_uEnclosingBase = enclosingBase;
 	const auto returnCode = RunFrame();
-	CloseUpValues(&m_oStack[m_pCurrentFrame->m_uBase]);
+	CloseUpValues(m_pCurrentFrame->m_uBase);
 	const Value ret = returnCode == ExecutionReturnCode::rc_return_value ? Pop() : Value();
 	PopFrame();
 	Push(ret);
@@ -149,7 +240,7 @@ void VM::RunClosure(Closure* closure)
 {
 	PushFrame(closure);
 	const auto returnCode = RunFrame();
-	CloseUpValues(&m_oStack[m_pCurrentFrame->m_uBase]);
+	CloseUpValues(m_pCurrentFrame->m_uBase);
 	const Value ret = returnCode == ExecutionReturnCode::rc_return_value ? Pop() : Value();
 	PopFrame();
 	Push(ret);
@@ -7,11 +7,15 @@
 #include "vm/value.hpp"
 #include "vm/gc/gc.hpp"
 #include "vm/heap/heap.hpp"
+#include "vm/memo.hpp"
+
+#include <optional>
 
 namespace bloop::bytecode {
 	enum class EOpCode : unsigned char;
 	struct CConstant;
 	struct VMByteCode;
+	using ConstantId = bloop::BloopUInt32;
 	namespace vmdata {
 		struct Function;
 	}
@@ -23,6 +27,7 @@ namespace bloop::vm
 	struct Capture {
 		bloop::BloopIndex m_uSlot{};
 		bool m_bIsLocal;
+		bool m_bByValue{};
 	};
 	struct CInstructionPosition {
 		bloop::BloopIndex byteOffset;
@@ -32,12 +37,17 @@ namespace bloop::vm
 		std::vector<Value> m_oConstants;
 		std::vector<BloopByte> m_oByteCode;
 		std::vector<CInstructionPosition> m_oPositions; //uses the same ip as m_oByteCode
+
+		[[nodiscard]] const CInstructionPosition* FindPosition(std::size_t ip) const;
 	};
 	struct Function {
+		bloop::BloopString m_sName;
 		Chunk chunk;
 		bloop::BloopIndex m_uParamCount{};
 		bloop::BloopIndex m_uLocalCount{};
 		std::vector<Capture> m_oCaptures{};
+		bloop::BloopUInt m_uNumCapturedConsts{}; // the rest of m_oCaptures are upvalues
+		std::optional<MemoCache> m_oMemo; // only for memo functions
 	};
 
 	struct CallFrame {
@@ -50,6 +60,7 @@ namespace bloop::vm
 		Chunk* m_pChunk{};
 		std::size_t m_uIp{};
 		std::size_t m_uBase{};
+		std::size_t m_uEnclosingBase{}; // base of the caller for CALL_ENCLOSED
 
 	};
 
@@ -62,6 +73,16 @@ namespace bloop::vm
 
 		void Run(const bloop::BloopString& entryFuncName);
 
+		// writes everything that is reachable from the roots, see HeapSnapshot
+		// the objects only have an allocation site when RecordAllocationSites was called before they were allocated
+		void WriteHeapSnapshot(const bloop::BloopString& path);
+		void RecordAllocationSites(bool record) noexcept { m_oHeap.m_bRecordSites = record; }
+
+		// runs a single function without the global chunk, used to evaluate calls at compile time
+		// fuel limits the calls and loop iterations, 0 means no limit
+		// the result is only reachable until the vm allocates again
+		[[nodiscard]] Value Call(bloop::BloopIndex functionId, const std::vector<bloop::bytecode::CConstant>& args, bloop::BloopUInt fuel = 0u);
+
 	private:
 		enum class ExecutionReturnCode : bloop::BloopByte {
 			rc_continue,
@@ -72,33 +93,47 @@ namespace bloop::vm
 		[[nodiscard]] ExecutionReturnCode RunFrame();
 		void RunGlobal();
 		void RunFunction(Function* fn);
+		void RunFunctionBody(Function* fn);
+		void RunMemoFunction(Function* fn);
+		void RunEnclosedFunction(Function* fn);
 		void RunClosure(Closure* closure);
 
 		void PushFrame(Function* fn);
 		void PushFrame(Closure* fn);
 		void PopFrame();
+		void ConsumeFuel();
 		void Push(const Value& v);
 		[[nodiscard]] Value Pop();
 
 		[[nodiscard]] std::vector<Value> BuildConstants(const std::vector<bloop::bytecode::CConstant>& constants);
+		[[nodiscard]] std::vector<Value> GetConstants(const std::vector<bloop::bytecode::ConstantId>& ids) const;
 		[[nodiscard]] ExecutionReturnCode InterpretOpCode(bloop::bytecode::EOpCode op);
 		[[nodiscard]] bloop::BloopIndex FetchOperand();
 
-		UpValue* CaptureUpValue(Value* slot);
-		void CloseUpValues(Value* lastSlot);
+		[[nodiscard]] Object* CaptureUpValue(std::size_t slot);
+		void CloseUpValues(std::size_t firstSlot);
 
 		std::vector<Value> m_oStack;
 		std::vector<CallFrame> m_oFrames;
 		std::vector<Function> m_oFunctions;
+		std::vector<Object> m_oFunctionObjects; // immortal, never part of the heap
 		std::unordered_map<bloop::BloopString, Function*> m_oFunctionTable;
 		std::vector<Value> m_oGlobals;
 		CallFrame* m_pCurrentFrame{};
+		bloop::BloopUInt m_uFuel{}; // 0 when unlimited
 
 		Heap m_oHeap;
 		GC m_oGC;
 		Chunk m_oGlobalChunk; //executed in the beginning
+		std::vector<Value> m_oConstants; // the program's constant pool, the chunks have copies of the values they use
+
+		// indexed by stack slot, so capturing an already open slot is O(1)
+		std::vector<Object*> m_oOpenUpValues;
+		// open slots in the order they were captured, a frame's slots are always above its caller's
+		std::vector<std::size_t> m_oOpenSlots;
 
-		UpValue* m_pOpenUpValues{};
+		// arguments of the memo calls that are still running, the callee can overwrite its own copies
+		std::vector<Value> m_oMemoArgs;
 	};
 
 }
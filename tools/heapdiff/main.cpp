@@ -0,0 +1,102 @@
+#include "vm/heap/snapshot.hpp"
+#include "utils/fmt.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+
+using namespace bloop::vm;
+
+struct GroupDiff {
+	bloop::BloopString m_sName;
+	HeapSummary::Entry m_oBefore;
+	HeapSummary::Entry m_oAfter;
+
+	[[nodiscard]] constexpr std::int64_t RetainedGrowth() const noexcept {
+		return static_cast<std::int64_t>(m_oAfter.m_uRetainedSize) - static_cast<std::int64_t>(m_oBefore.m_uRetainedSize);
+	}
+	[[nodiscard]] constexpr std::int64_t CountGrowth() const noexcept {
+		return static_cast<std::int64_t>(m_oAfter.m_uCount) - static_cast<std::int64_t>(m_oBefore.m_uCount);
+	}
+};
+
+[[nodiscard]] static std::vector<GroupDiff> DiffGroups(const std::map<bloop::BloopString, HeapSummary::Entry>& before,
+	const std::map<bloop::BloopString, HeapSummary::Entry>& after) {
+
+	std::set<bloop::BloopString> names;
+	for (const auto& [name, _] : before)
+		names.insert(name);
+	for (const auto& [name, _] : after)
+		names.insert(name);
+
+	std::vector<GroupDiff> diffs;
+	for (const auto& name : names) {
+		GroupDiff d;
+		d.m_sName = name;
+		if (const auto it = before.find(name); it != before.end())
+			d.m_oBefore = it->second;
+		if (const auto it = after.find(name); it != after.end())
+			d.m_oAfter = it->second;
+		diffs.push_back(d);
+	}
+
+	std::ranges::stable_sort(diffs, [](const GroupDiff& a, const GroupDiff& b) {
+		return a.RetainedGrowth() > b.RetainedGrowth();
+	});
+	return diffs;
+}
+
+[[nodiscard]] static bloop::BloopString Signed(std::int64_t v) {
+	return v > 0 ? BLOOPTEXT("+") + std::to_string(v) : std::to_string(v);
+}
+
+static void PrintGroups(const char* title, const std::vector<GroupDiff>& diffs, std::size_t limit) {
+
+	std::cout << '\n' << title << ":\n";
+	std::cout << std::left << std::setw(40) << "  name" << std::right
+		<< std::setw(12) << "count" << std::setw(12) << "+count"
+		<< std::setw(14) << "retained" << std::setw(14) << "+retained" << '\n';
+
+	const auto changed = [](const GroupDiff& d) { return d.RetainedGrowth() || d.CountGrowth(); };
+
+	// the unchanged groups don't count towards the limit
+	for (const auto& d : diffs | std::views::filter(changed) | std::views::take(limit)) {
+		std::cout << std::left << std::setw(40) << ("  " + d.m_sName) << std::right
+			<< std::setw(12) << d.m_oAfter.m_uCount << std::setw(12) << Signed(d.CountGrowth())
+			<< std::setw(14) << d.m_oAfter.m_uRetainedSize << std::setw(14) << Signed(d.RetainedGrowth()) << '\n';
+	}
+}
+
+int main(int argc, char** argv) {
+
+	if (argc < 3) {
+		std::cout << "usage: bloop_heapdiff <before> <after> [max sites]\n";
+		return 1;
+	}
+
+	try {
+		const auto before = HeapSummary::Compute(HeapSnapshot::Read(argv[1]));
+		const auto after = HeapSummary::Compute(HeapSnapshot::Read(argv[2]));
+		const auto maxSites = argc > 3 ? static_cast<std::size_t>(std::stoull(argv[3])) : std::size_t{ 20 };
+
+		std::cout << bloop::fmt::format(BLOOPTEXT("objects: {} -> {} ({})\n"),
+			before.m_uNumObjects, after.m_uNumObjects,
+			Signed(static_cast<std::int64_t>(after.m_uNumObjects) - static_cast<std::int64_t>(before.m_uNumObjects)));
+
+		std::cout << bloop::fmt::format(BLOOPTEXT("bytes: {} -> {} ({})\n"),
+			before.m_uTotalSize, after.m_uTotalSize,
+			Signed(static_cast<std::int64_t>(after.m_uTotalSize) - static_cast<std::int64_t>(before.m_uTotalSize)));
+
+		PrintGroups("retained size growth by type", DiffGroups(before.m_oByType, after.m_oByType), std::numeric_limits<std::size_t>::max());
+		PrintGroups("retained size growth by allocation site", DiffGroups(before.m_oBySite, after.m_oBySite), maxSites);
+
+	} catch (std::exception& ex) {
+		std::cout << ex.what() << '\n';
+		return 1;
+	}
+
+	return 0;
+}
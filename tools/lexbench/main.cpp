@@ -0,0 +1,124 @@
+#include "lexer/lexer.hpp"
+#include "utils/fmt.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+using namespace bloop::lexer;
+
+// looks like the machine generated scripts: comment headers, functions and big data tables
+// with a long last line, the script ends in one table that is longer than any piece the lexer splits it into
+[[nodiscard]] static bloop::BloopString GenerateScript(std::size_t size, bool longLastLine = false) {
+
+	std::mt19937 rng(1234u);
+	std::uniform_int_distribution<int> number(0, 99999);
+	std::uniform_int_distribution<int> kind(0, 9);
+
+	bloop::BloopString script;
+	script.reserve(size + 0x1000u);
+
+	for (std::size_t i{}; script.size() < size; i++) {
+		switch (kind(rng)) {
+		case 0:
+			script += BLOOPTEXT("/*\n * generated section ") + std::to_string(i) + BLOOPTEXT("\n * do not edit\n */\n");
+			break;
+		case 1:
+			script += BLOOPTEXT("// table of values, \"quoted\" and 'single'\n");
+			break;
+		case 2:
+		case 3:
+			script += BLOOPTEXT("fn func") + std::to_string(i) + BLOOPTEXT("(a, b) {\n\tlet result = a * b + ")
+				+ std::to_string(number(rng)) + BLOOPTEXT(";\n\tif (result > 0x1F) {\n\t\treturn result - 1;\n\t}\n\treturn \"line\\tend\\n\";\n}\n");
+			break;
+		default:
+			script += BLOOPTEXT("let table") + std::to_string(i) + BLOOPTEXT(" = [");
+			for (auto j = 0; j < 32; j++)
+				script += std::to_string(number(rng)) + (j % 4 == 0 ? BLOOPTEXT(".5, ") : BLOOPTEXT(", "));
+			script += BLOOPTEXT("1_000];\n");
+			break;
+		}
+	}
+
+	if (longLastLine) {
+		const auto end = script.size() * 2u;
+		script += BLOOPTEXT("let last = [");
+		while (script.size() < end)
+			script += std::to_string(number(rng)) + BLOOPTEXT(", ");
+		script += BLOOPTEXT("0];\n");
+	}
+	return script;
+}
+
+[[nodiscard]] static bool SameTokens(const std::vector<bloop::CToken>& a, const std::vector<bloop::CToken>& b) {
+	return std::ranges::equal(a, b, [](const bloop::CToken& x, const bloop::CToken& y) {
+		return x.Type() == y.Type() && x.m_ePunctuation == y.m_ePunctuation
+			&& x.Source() == y.Source() && x.GetCodePosition() == y.GetCodePosition() && x.NameId() == y.NameId();
+	});
+}
+
+// the fastest of a few runs, in milliseconds
+template<typename Run>
+[[nodiscard]] static double Measure(std::size_t repetitions, Run&& run) {
+	auto best = std::numeric_limits<double>::max();
+	for (std::size_t i{}; i < repetitions; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		run();
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv) {
+
+	const auto megabytes = argc > 1 ? static_cast<std::size_t>(std::stoull(argv[1])) : std::size_t{ 16 };
+	const auto repetitions = argc > 2 ? static_cast<std::size_t>(std::stoull(argv[2])) : std::size_t{ 5 };
+	const auto maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	try {
+		const auto script = GenerateScript(megabytes << 20u);
+
+		CLexer reference(script);
+		reference.Parse();
+		const auto sequential = Measure(repetitions, [&script]() { CLexer(script).Parse(); });
+
+		std::cout << bloop::fmt::format(BLOOPTEXT("{} bytes, {} tokens\n"), script.size(), reference.GetTokens().size());
+		std::cout << std::fixed << std::setprecision(2) << "sequential: " << sequential << " ms\n";
+
+		// the last piece must not be empty when the script ends in a long line
+		const auto longScript = GenerateScript(megabytes << 20u, true);
+		CLexer longReference(longScript);
+		longReference.Parse();
+
+		for (std::size_t threads = 2u; threads <= std::max<std::size_t>(maxThreads, 4u); threads *= 2u) {
+			CLexer lexer(longScript);
+			lexer.ParseParallel(threads);
+
+			if (!SameTokens(lexer.GetTokens(), longReference.GetTokens()))
+				throw std::runtime_error(bloop::fmt::format(BLOOPTEXT("{} threads produced different tokens for a long last line"), threads));
+		}
+
+		for (std::size_t threads = 1u; threads <= maxThreads; threads *= 2u) {
+			CLexer lexer(script);
+			lexer.ParseParallel(threads);
+
+			if (!SameTokens(lexer.GetTokens(), reference.GetTokens()))
+				throw std::runtime_error(bloop::fmt::format(BLOOPTEXT("{} threads produced different tokens"), threads));
+
+			const auto elapsed = Measure(repetitions, [&script, threads]() { CLexer(script).ParseParallel(threads); });
+			std::cout << std::setw(3) << threads << " threads: " << std::setw(8) << elapsed << " ms, " << sequential / elapsed << "x\n";
+		}
+
+	} catch (std::exception& ex) {
+		std::cout << ex.what() << '\n';
+		return 1;
+	}
+
+	return 0;
+}